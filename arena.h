@@ -0,0 +1,103 @@
+//The Deep Below
+//scratch memory for a turn. whatever a turn or a scene only needs until it
+//has been shown, the rows drawn, the events and what the scene said, is
+//bumped out of one block through std::pmr, and the whole block is taken back
+//at once when the next turn or scene step starts. a turn that outgrows the
+//block borrows from the heap and the block is grown to fit for next time, so
+//once a game settles its turns never touch the heap
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <memory_resource>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+
+static const size_t SCRATCH_BYTES = 64 * 1024; //block a game starts with
+
+//a heap piece borrowed when the block ran out
+struct Spill {
+  void *memory;
+  size_t bytes, align;
+};
+
+struct Arena : std::pmr::memory_resource {
+  std::vector<char> block;   //the scratch, kept from turn to turn
+  size_t used;               //bytes handed out of the block since the last reset
+  size_t spilled;            //bytes borrowed from the heap since the last reset
+  size_t most;               //most any turn has needed
+  long long resets;          //turns and scene steps it has been taken back after
+  std::vector<Spill> spills; //given back at the reset
+
+  Arena() : block(SCRATCH_BYTES), used(0), spilled(0), most(0), resets(0) {}
+  ~Arena() {
+    Reset();
+  }
+  Arena(const Arena &) = delete; //the block is handed out, it cant move
+  Arena &operator=(const Arena &) = delete;
+
+  //takes everything back, nothing handed out may still be in use
+  void Reset() {
+    for (long long unsigned int i = 0; i < spills.size(); i++)
+      std::pmr::new_delete_resource()->deallocate(spills[i].memory, spills[i].bytes, spills[i].align);
+    spills.clear();
+
+    if (used + spilled > most)
+      most = used + spilled;
+    if (most > block.size())
+      block.resize(most + most / 4); //room to spare so it settles quickly
+
+    used = 0;
+    spilled = 0;
+    resets++;
+  }
+
+ protected:
+  void *do_allocate(size_t bytes, size_t align) override {
+    uintptr_t base = (uintptr_t)block.data();
+    size_t start = ((base + used + align - 1) & ~(uintptr_t)(align - 1)) - base;
+
+    if (start + bytes <= block.size()) {
+      used = start + bytes;
+      return block.data() + start;
+    }
+
+    Spill spill = {std::pmr::new_delete_resource()->allocate(bytes, align), bytes, align};
+    spills.push_back(spill);
+    spilled += bytes;
+    return spill.memory;
+  }
+
+  //pieces are only taken back all together by Reset
+  void do_deallocate(void *, size_t, size_t) override {}
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+//a stream buffer that writes into an arena string, so text can be put
+//together with << without a stringstream of its own on the heap
+struct ArenaText : std::streambuf {
+  std::pmr::string *text;
+
+  explicit ArenaText(std::pmr::string *text) : text(text) {}
+
+ protected:
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      text->push_back(traits_type::to_char_type(c));
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char *s, std::streamsize count) override {
+    text->append(s, count);
+    return count;
+  }
+};
+
+#endif
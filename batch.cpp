@@ -0,0 +1,292 @@
+//The Deep Below
+//headless balance runs. every game gets its own seed and plays on its own
+//Game, so games run side by side on a work stealing pool of threads:
+//  > ./main --batch 1000 --threads 8 --turns 300 --seed 1
+
+
+#include "batch.h"
+#include "profile.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+
+//jobs waiting on one thread, others steal from the front when they run dry
+struct Worker {
+  std::mutex lock;
+  std::deque<int> jobs;
+};
+
+//function prototypes
+static std::string BotAnswer(Game &world);
+static int  BotAction(Game &world, int &steps, int turn);
+static void RunWorker(int id, std::vector<Worker> &workers, std::vector<GameResult> &results,
+                      unsigned int seed, int turns, int size);
+static void PrintSpread(const char *name, std::vector<int> values);
+
+
+//runs the batch asked for on the command line and prints the results
+//parameters: command line, after --batch comes the number of games then any of
+//--threads, --turns, --seed and --size, and --profile or --trace
+//returns the exit code
+int Batch(int argc, char *argv[]) {
+  int games = argc > 2 ? atoi(argv[2]) : 100;
+  int threads = (int)std::thread::hardware_concurrency();
+  int turns = 300;
+  int size = DEFAULT_GRID;
+  unsigned int seed = 1;
+
+  for (int i = 3; i + 1 < argc; i++) {
+    std::string flag = argv[i];
+    if (flag == "--threads")
+      threads = atoi(argv[++i]);
+    else if (flag == "--turns")
+      turns = atoi(argv[++i]);
+    else if (flag == "--seed")
+      seed = (unsigned int)atoi(argv[++i]);
+    else if (flag == "--size")
+      size = atoi(argv[++i]);
+  }
+  if (games < 1)
+    games = 1;
+  if (threads < 1)
+    threads = 1;
+  if (threads > games)
+    threads = games;
+
+  //deals the games out evenly, stealing evens out the slow ones
+  std::vector<Worker> workers(threads);
+  std::vector<GameResult> results(games);
+  for (int i = 0; i < games; i++)
+    workers[i % threads].jobs.push_back(i);
+
+  std::cout << "Playing " << games << " games of " << turns << " turns on ";
+  std::cout << threads << " threads, seeds " << seed << " to " << seed + games - 1;
+  std::cout << ", " << size << "x" << size << " mines\n";
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::vector<std::thread> pool;
+  for (int i = 0; i < threads; i++)
+    pool.push_back(std::thread(RunWorker, i, std::ref(workers), std::ref(results), seed, turns, size));
+  for (int i = 0; i < threads; i++)
+    pool[i].join();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<int> scores, played, upgrades;
+  int revived = 0, dead = 0;
+  int acquired[UPGRADE_UPPER] = {0};
+
+  for (int i = 0; i < games; i++) {
+    int upg = 0;
+    scores.push_back(results[i].score);
+    played.push_back(results[i].turns);
+    revived += results[i].revived;
+    dead += results[i].dead;
+    for (int j = 0; j < UPGRADE_UPPER; j++) {
+      upg += results[i].upgrades[j];
+      if (results[i].upgrades[j] > 0)
+        acquired[j]++;
+    }
+    upgrades.push_back(upg);
+  }
+
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "Done in " << seconds << "s, " << games / seconds << " games/s\n\n";
+  std::cout << "                 mean      min      p10      p50      p90      max\n";
+  PrintSpread("Score", scores);
+  PrintSpread("Turns survived", played);
+  PrintSpread("Upgrade levels", upgrades);
+
+  std::cout << "\nRevived:  " << revived * 100.0 / games << "% of games\n";
+  std::cout << "Died:     " << dead * 100.0 / games << "% of games\n";
+
+  const char *names[UPGRADE_UPPER] = {"Damage", "Sight", "Width", "Depth", "Clarity", "Health", "Compass"};
+  std::cout << "\nGames that got each upgrade:\n";
+  for (int j = 0; j < UPGRADE_UPPER; j++)
+    std::cout << "  " << std::left << std::setw(8) << names[j] << std::right << acquired[j] * 100.0 / games << "%\n";
+
+  if (profiling) {
+    std::cout << "\nTimes across every thread:\n";
+    ProfileReport(std::cout);
+  }
+  return 0;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//plays one game start to finish with the bot
+//parameters: seed for the game, the most commands the bot gets, blocks per
+//side of the map
+GameResult PlayBot(unsigned int seed, int turns, int size) {
+  std::unique_ptr<Game> world(new Game);
+  GameResult result;
+  int turn = 0;
+
+  world->carveThreads = 1; //the other games already fill the cores
+  world->Init(seed, size);
+  world->Upgrade(world->Rand() % UPGRADE_UPPER); //the intro's blessing
+
+  while (world->game && turn < turns) {
+    ProfileScope scope(TURN_PHASE);
+    int steps = 1;
+    bool update = world->Act(BotAction(*world, steps, turn), steps);
+
+    //the bot answers scenes as they come, nobody reads the events
+    while (world->scene.kind != NO_SCENE)
+      world->StepScene(BotAnswer(*world));
+    world->EndTurn(update);
+    while (world->scene.kind != NO_SCENE)
+      world->StepScene(BotAnswer(*world));
+    world->events.clear();
+    turn++;
+  }
+
+  result.score = world->Score();
+  result.turns = turn;
+  result.revived = world->player["died"] >= 1;
+  result.dead = world->player["health"] <= 0;
+  for (int i = 0; i < UPGRADE_UPPER; i++)
+    result.upgrades[i] = world->upgrades[i];
+  return result;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//picks the bots next command: heads to a shop when hurt or loaded with ore,
+//otherwise digs toward whichever side has the most buried in it
+//parameters: game, set to the steps a move takes, turn number
+//returns the action, like the console's input
+static int BotAction(Game &world, int &steps, int turn) {
+  std::map<std::string, int> &player = world.player;
+
+  //tries a shop every few turns, travel gives up when it cant find a way
+  if ((player["health"] < player["maxHP"] / 2 || player["ore"] >= 20) && turn % 5 == 0)
+    return 8;
+
+  int y = player["y"];
+  int x = player["x"];
+  int r = PROSPECT_RANGE;
+  int areas[4][4] = {{y-r, x-r, y-1, x+r},
+                     {y-r, x-r, y+r, x-1},
+                     {y+1, x-r, y+r, x+r},
+                     {y-r, x+1, y+r, x+r}};
+  int best = 0, bestWorth = -1;
+
+  for (int i = 0; i < 4; i++) {
+    int worth = world.CountResource(0, areas[i][0], areas[i][1], areas[i][2], areas[i][3]) +
+                world.CountResource(1, areas[i][0], areas[i][1], areas[i][2], areas[i][3]) * 6;
+    if (worth > bestWorth) {
+      best = i;
+      bestWorth = worth;
+    }
+  }
+
+  steps = 5;
+  return best; //directions are 0 up, 1 left, 2 down, 3 right
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//answers the scene playing the way a careful player would
+//parameter: game with the scene
+//returns the answer
+static std::string BotAnswer(Game &world) {
+  std::map<std::string, int> &player = world.player;
+  Scene &scene = world.scene;
+
+  switch (scene.kind) {
+    case SHOP_SCENE: {
+      if (scene.step == 1 || scene.step == 2) //wants to shop
+        return "y";
+      if (scene.step == 4) //sells all the ore
+        return std::to_string(player["ore"]);
+
+      Shop &shop = world.ShopAt(scene.y, scene.x);
+      int afford = player["coins"] / ARTIFACT_PRICE;
+      if (scene.step == 5) //spends the coins on what artifacts the shop has
+        return std::to_string(afford < shop.stock ? afford : shop.stock);
+      if (scene.step == 6) //takes the deal if it can
+        return player["artifacts"] >= scene.cost ? "y" : "n";
+      if (player["ore"] > 0)
+        return "1";
+      if (!scene.asked)
+        return "3";
+      if (afford > 0 && shop.stock > 0)
+        return "2";
+      return "4";
+    }
+
+    case FIGHT_SCENE:
+      return player["health"] > 10 ? "y" : "n";
+
+    case MINIBOSS_SCENE: //runs once a hit could be the last
+      return player["health"] > scene.damage + 3 ? "1" : "3";
+
+    case BOSS_SCENE: //the boss ends the game, so the bot stays away
+      return "n";
+  }
+  return "";
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//plays games until every thread has run out of work
+//parameters: thread number, everyones jobs, where results go, first seed,
+//most turns per game and blocks per side of the map
+static void RunWorker(int id, std::vector<Worker> &workers, std::vector<GameResult> &results,
+                      unsigned int seed, int turns, int size) {
+  int count = workers.size();
+
+  while (true) {
+    int job = -1;
+
+    //own jobs first, from the back
+    {
+      std::lock_guard<std::mutex> guard(workers[id].lock);
+      if (!workers[id].jobs.empty()) {
+        job = workers[id].jobs.back();
+        workers[id].jobs.pop_back();
+      }
+    }
+
+    //then steals from the front of someone elses
+    for (int i = 1; i < count && job == -1; i++) {
+      Worker &other = workers[(id + i) % count];
+      std::lock_guard<std::mutex> guard(other.lock);
+      if (!other.jobs.empty()) {
+        job = other.jobs.front();
+        other.jobs.pop_front();
+      }
+    }
+
+    if (job == -1) //no jobs are ever added, so empty everywhere means done
+      return;
+
+    results[job] = PlayBot(seed + job, turns, size);
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//prints the mean and spread of one result
+//parameters: row name and the values from every game
+static void PrintSpread(const char *name, std::vector<int> values) {
+  long long total = 0;
+  int size = values.size();
+
+  std::sort(values.begin(), values.end());
+  for (int i = 0; i < size; i++)
+    total += values[i];
+
+  std::cout << std::left << std::setw(15) << name << std::right;
+  std::cout << std::setw(7) << (double)total / size;
+  std::cout << std::setw(9) << values[0];
+  std::cout << std::setw(9) << values[size / 10];
+  std::cout << std::setw(9) << values[size / 2];
+  std::cout << std::setw(9) << values[size * 9 / 10];
+  std::cout << std::setw(9) << values[size - 1] << '\n';
+}
@@ -0,0 +1,22 @@
+//The Deep Below
+//headless balance runs, plays many games at once with a scripted bot and
+//prints how they turned out
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "core.h"
+
+//how one bot game turned out
+struct GameResult {
+  int  score;    //final score, as the game report counts it
+  int  turns;    //commands the bot got in before the game ended
+  int  revived;  //1 if the player used up their revive
+  int  dead;     //1 if the game ended with the player dead
+  int  upgrades[UPGRADE_UPPER]; //level of each upgrade at the end
+};
+
+int  Batch(int argc, char *argv[]);
+GameResult PlayBot(unsigned int seed, int turns, int size = DEFAULT_GRID);
+
+#endif
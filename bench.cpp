@@ -0,0 +1,655 @@
+//The Deep Below
+//microbenchmarks for the hot parts of the game. every benchmark warms up,
+//then times a run of samples and reports the median and median absolute
+//deviation, written out as json so builds can be compared:
+//  > g++ -O2 bench.cpp core.cpp console.cpp profile.cpp world.cpp noise.cpp caves.cpp -pthread -o bench
+//  > ./bench results.json
+//--sweep times each part of the game and its peak memory at several map
+//sizes instead, every size in its own process so the peaks dont mix:
+//  > ./bench --sweep 500 1000 2000 4000 8000 > sweep.json
+//where perf counters are allowed dTLB load misses are counted too, and
+//--small-pages keeps the map off huge pages to compare against:
+//  > ./bench --small-pages --sweep 8000
+//every operator new is counted, and once the caches are warm a stretch of
+//walking turns is played after the benchmarks to check they make no heap
+//allocations at all. the exit code is 1 if they do, or if save.txt doesnt
+//load. travel searches paths and isnt held to that, its trips are counted on
+//their own as travel_allocations
+
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32 //sizes run one after another in this process
+#include <malloc.h> //_aligned_malloc
+#else
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#if defined(__linux__) //tlb misses are only counted on linux
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "core.h"
+#include "console.h"
+#include "profile.h"
+#include "caves.h"
+
+
+//one benchmarks results, times are per call in nanoseconds
+struct BenchResult {
+  std::string name;
+  int  samples;      //timed samples, not counting warmup
+  int  calls;        //calls timed together in each sample
+  double median, mad, min, max;
+  double tlbMisses;  //dTLB load misses per call, -1 without perf counters
+};
+
+//swallows whatever is printed to it
+struct NullBuffer : std::streambuf {
+  int overflow(int c) { return c; }
+};
+
+//a step of a benchmark, gets the sample number so it can work somewhere fresh
+typedef void (*BenchStep)(Game &world, int sample);
+
+//Constants
+static const unsigned int SEED = 1; //every run generates the same mines
+static const int COLLECT_CALLS = 64; //blocks dug in a row per CollectItem sample
+static const int COLLECT_ROWS = (DEFAULT_GRID - 40) / 8; //rows of fresh dirt, 8 apart
+static const int WARM_TURNS = 200; //turns played before counting, caches fill in these
+static const int COUNTED_TURNS = 1000; //turns whose heap allocations are counted
+static const int TRAVEL_TRIPS = 10; //trips to a shop and back to a mark after them
+
+static std::string saveText; //save.txt, read once
+static int tlbCounter = -1; //perf counter of dTLB load misses, -1 if not allowed
+static std::vector<BenchResult> results;
+static long long heapAllocations = 0; //operator news in this process so far
+static long long turnAllocations = -1; //operator news in the counted turns
+static long long travelAllocations = -1; //operator news in the travel trips
+
+//function prototypes
+static void Measure(const char *name, Game &world, BenchStep setup, BenchStep body,
+                    int warmup, int samples, int calls);
+static double Median(std::vector<double> values);
+static void WriteJson(std::ostream &out);
+static void Generate(Game &world, int sample);
+static void Carve(Game &world, int sample);
+static void Tick(Game &world, int sample);
+static void PlaceDigger(Game &world, int sample);
+static void Dig(Game &world, int sample);
+static void Draw(Game &world, int sample);
+static void Save(Game &world, int sample);
+static void Load(Game &world, int sample);
+static void PlayTurns(Game &world, int turns);
+static void PlayTurn(Game &world, int action, int steps);
+static void PlayTrips(Game &world, int trips);
+static void WarmOdds(Game &world);
+static int  Sweep(int argc, char *argv[]);
+static void SweepSize(int size);
+static double Seconds(std::chrono::steady_clock::time_point start);
+static void OpenCounter();
+static void CounterStart();
+static long long CounterStop();
+static void *Allocate(size_t bytes, size_t align, bool nothrow);
+static void Release(void *memory, size_t align);
+
+
+//every allocation goes through here so turns can be checked for them, the
+//array, nothrow and over-aligned forms of new included
+//parameters: bytes wanted, alignment, true to return NULL instead of throwing
+//returns the memory
+static void *Allocate(size_t bytes, size_t align, bool nothrow) {
+  heapAllocations++;
+  if (bytes == 0)
+    bytes = 1;
+
+  void *memory = NULL;
+  if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    memory = malloc(bytes);
+  else {
+#ifdef _WIN32
+    memory = _aligned_malloc(bytes, align);
+#else
+    if (posix_memalign(&memory, align, bytes) != 0)
+      memory = NULL;
+#endif
+  }
+
+  if (memory == NULL && !nothrow)
+    throw std::bad_alloc();
+  return memory;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//gives back memory from Allocate, the way it was allocated
+//parameters: the memory and the alignment it was allocated with
+static void Release(void *memory, size_t align) {
+#ifdef _WIN32
+  if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    _aligned_free(memory);
+    return;
+  }
+#else
+  (void)align;
+#endif
+  free(memory);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+void *operator new(size_t bytes) { return Allocate(bytes, 0, false); }
+void *operator new[](size_t bytes) { return Allocate(bytes, 0, false); }
+void *operator new(size_t bytes, const std::nothrow_t &) noexcept { return Allocate(bytes, 0, true); }
+void *operator new[](size_t bytes, const std::nothrow_t &) noexcept { return Allocate(bytes, 0, true); }
+void *operator new(size_t bytes, std::align_val_t align) { return Allocate(bytes, (size_t)align, false); }
+void *operator new[](size_t bytes, std::align_val_t align) { return Allocate(bytes, (size_t)align, false); }
+void *operator new(size_t bytes, std::align_val_t align, const std::nothrow_t &) noexcept {
+  return Allocate(bytes, (size_t)align, true);
+}
+void *operator new[](size_t bytes, std::align_val_t align, const std::nothrow_t &) noexcept {
+  return Allocate(bytes, (size_t)align, true);
+}
+
+//gcc sees new and delete inlined down to malloc and free and takes them for a
+//mismatched pair, but every new above is given back by the delete below
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *memory) noexcept { Release(memory, 0); }
+void operator delete[](void *memory) noexcept { Release(memory, 0); }
+void operator delete(void *memory, size_t) noexcept { Release(memory, 0); }
+void operator delete[](void *memory, size_t) noexcept { Release(memory, 0); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept { Release(memory, 0); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { Release(memory, 0); }
+void operator delete(void *memory, std::align_val_t align) noexcept { Release(memory, (size_t)align); }
+void operator delete[](void *memory, std::align_val_t align) noexcept { Release(memory, (size_t)align); }
+void operator delete(void *memory, size_t, std::align_val_t align) noexcept { Release(memory, (size_t)align); }
+void operator delete[](void *memory, size_t, std::align_val_t align) noexcept { Release(memory, (size_t)align); }
+void operator delete(void *memory, std::align_val_t align, const std::nothrow_t &) noexcept {
+  Release(memory, (size_t)align);
+}
+void operator delete[](void *memory, std::align_val_t align, const std::nothrow_t &) noexcept {
+  Release(memory, (size_t)align);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[]) {
+  //--small-pages can go anywhere, the rest of the line is read without it
+  int kept = 1;
+  for (int i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "--small-pages")
+      hugePages = false;
+    else
+      argv[kept++] = argv[i];
+  }
+  argc = kept;
+
+  if (argc > 1 && std::string(argv[1]) == "--sweep")
+    return Sweep(argc, argv);
+  OpenCounter();
+
+  static Game world;
+  NullBuffer null;
+  std::streambuf *console = std::cout.rdbuf();
+
+  std::ifstream MyFile("save.txt");
+  if (MyFile) {
+    std::stringstream text;
+    text << MyFile.rdbuf();
+    saveText = text.str();
+  }
+
+  world.Init(SEED);
+  Measure("GenerateGrid", world, NULL, Generate, 1, 9, 1);
+  Measure("CarveCaves", world, NULL, Carve, 1, 9, 1);
+
+  world.Init(SEED);
+  Measure("MoveMiners", world, NULL, Tick, 5, 31, 1);
+
+  //every width and depth upgrade pairing digs a different shape. each
+  //upgrade goes straight from 0 to 3, so those are the only levels there are
+  const int levels[2] = {0, 3};
+  const char *names[2] = {"0", "3"};
+  for (int width = 0; width < 2; width++) {
+    for (int depth = 0; depth < 2; depth++) {
+      std::string name = std::string("CollectItem/width") + names[width] + "/depth" + names[depth];
+      world.Init(SEED);
+      world.upgrades[2] = levels[width];
+      world.upgrades[3] = levels[depth];
+      Measure(name.c_str(), world, PlaceDigger, Dig, 3, 21, COLLECT_CALLS);
+    }
+  }
+
+  //the grid goes nowhere, only the work of drawing it is timed
+  world.Init(SEED);
+  std::cout.rdbuf(&null);
+  Measure("PrintGrid", world, NULL, Draw, 5, 51, 1);
+  std::cout.rdbuf(console);
+
+  if (saveText.empty())
+    std::cerr << "No save.txt here, skipping LoadGame\n";
+  else
+    Measure("LoadGame", world, NULL, Load, 1, 9, 1);
+  Measure("SaveGame", world, NULL, Save, 1, 9, 1);
+
+  //the flow fields and anything else made on first use are made while
+  //warming up, after that a turn should only use the games scratch
+  world.Init(SEED);
+  for (int ry = 0; ry < world.regionSide; ry++)
+    for (int rx = 0; rx < world.regionSide; rx++)
+      world.FlowDistance(ry * FLOW_REGION, rx * FLOW_REGION);
+  std::cout.rdbuf(&null);
+  PlayTurns(world, WARM_TURNS);
+  WarmOdds(world);
+  long long before = heapAllocations;
+  PlayTurns(world, COUNTED_TURNS);
+  turnAllocations = heapAllocations - before;
+  before = heapAllocations;
+  PlayTrips(world, TRAVEL_TRIPS);
+  travelAllocations = heapAllocations - before;
+  std::cout.rdbuf(console);
+  std::cerr << "Heap allocations in " << COUNTED_TURNS << " walking turns: " << turnAllocations << '\n';
+  std::cerr << "Heap allocations in " << TRAVEL_TRIPS << " travel trips: " << travelAllocations << '\n';
+
+  if (argc > 1) {
+    std::ofstream out(argv[1]);
+    WriteJson(out);
+    if (!out) {
+      std::cerr << "Couldn't write " << argv[1] << '\n';
+      return 1;
+    }
+  }
+  else
+    WriteJson(std::cout);
+  return turnAllocations > 0 ? 1 : 0;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//runs one benchmark and keeps its results
+//parameters: name, game to run on, step run before each sample without
+//timing it or NULL, step timed, samples thrown away to warm up, samples
+//kept, calls the timed step makes
+static void Measure(const char *name, Game &world, BenchStep setup, BenchStep body,
+                    int warmup, int samples, int calls) {
+  std::vector<double> times, spread;
+  long long misses = 0;
+
+  for (int i = 0; i < warmup + samples; i++) {
+    if (setup != NULL)
+      setup(world, i);
+
+    CounterStart();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    body(world, i);
+    double took = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    long long missed = CounterStop();
+
+    if (i >= warmup) {
+      times.push_back(took / calls);
+      misses = missed < 0 || misses < 0 ? -1 : misses + missed;
+    }
+  }
+
+  BenchResult result;
+  result.name = name;
+  result.samples = samples;
+  result.calls = calls;
+  result.median = Median(times);
+  for (long long unsigned int i = 0; i < times.size(); i++)
+    spread.push_back(std::fabs(times[i] - result.median));
+  result.mad = Median(spread);
+  result.min = *std::min_element(times.begin(), times.end());
+  result.max = *std::max_element(times.begin(), times.end());
+  result.tlbMisses = misses < 0 ? -1 : (double)misses / samples / calls;
+  results.push_back(result);
+
+  std::cerr << std::fixed << std::setprecision(1);
+  std::cerr << name << ": " << result.median << "ns +- " << result.mad << "ns";
+  if (misses >= 0)
+    std::cerr << ", " << result.tlbMisses << " dTLB misses";
+  std::cerr << '\n';
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//middle value
+//parameter: values, not empty
+//returns the median
+static double Median(std::vector<double> values) {
+  int size = values.size();
+
+  std::sort(values.begin(), values.end());
+  if (size % 2 == 1)
+    return values[size / 2];
+  return (values[size / 2 - 1] + values[size / 2]) / 2;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//writes every result as json
+//parameter: where to write
+static void WriteJson(std::ostream &out) {
+  out << std::fixed << std::setprecision(1);
+  out << "{\n  \"grid\": " << DEFAULT_GRID << ",\n  \"huge_pages\": " << (hugePages ? "true" : "false");
+  out << ",\n  \"unit\": \"ns\",\n  \"benchmarks\": [\n";
+  for (long long unsigned int i = 0; i < results.size(); i++) {
+    BenchResult &result = results[i];
+    out << "    {\"name\": \"" << result.name << "\", \"samples\": " << result.samples;
+    out << ", \"calls\": " << result.calls << ", \"median\": " << result.median;
+    out << ", \"mad\": " << result.mad << ", \"min\": " << result.min;
+    out << ", \"max\": " << result.max << ", \"dtlb_misses\": " << result.tlbMisses;
+    out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ],\n  \"turn_allocations\": " << turnAllocations;
+  out << ",\n  \"travel_allocations\": " << travelAllocations << "\n}\n";
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//makes the mines again from the same seed
+static void Generate(Game &world, int sample) {
+  (void)sample;
+  world.Init(SEED);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//carves the caves again over the mines, it takes as long whatever is there
+static void Carve(Game &world, int sample) {
+  CarveCaves(world.grid, SEED + sample, world.carveThreads);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//gives every miner one turn
+static void Tick(Game &world, int sample) {
+  (void)sample;
+  world.MoveMiners();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//puts the player at the start of an undug row, each sample gets its own
+static void PlaceDigger(Game &world, int sample) {
+  world.player["y"] = 20 + (sample % COLLECT_ROWS) * 8;
+  world.player["x"] = 20 + (sample / COLLECT_ROWS) * (COLLECT_CALLS + 8);
+  world.scene = Scene();
+  world.events.clear();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//digs right along the row. the player is slid along without being placed on
+//the grid, so only the digging itself is timed
+static void Dig(Game &world, int sample) {
+  (void)sample;
+  for (int i = 0; i < COLLECT_CALLS; i++) {
+    world.CollectItem(world.player["y"], world.player["x"] + 1);
+    world.player["x"]++;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//draws the view around the player
+static void Draw(Game &world, int sample) {
+  (void)sample;
+  world.fovValid = false; //casts sight again like after a move
+  PrintGrid(world);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//saves the whole game to memory
+static void Save(Game &world, int sample) {
+  (void)sample;
+  std::ostringstream out;
+  world.SaveGame(out);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//loads save.txt from memory, a save that wont load ends the bench
+static void Load(Game &world, int sample) {
+  (void)sample;
+  std::istringstream in(saveText);
+  if (!world.LoadGame(in)) {
+    std::cerr << "save.txt didn't load\n";
+    exit(1);
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//plays turns the way the console does, single steps and runs around a square
+//parameters: game to play, turns to play
+static void PlayTurns(Game &world, int turns) {
+  for (int i = 0; i < turns; i++)
+    PlayTurn(world, (i / 30) % 4, i % 2 == 0 ? 1 : 5);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//plays one turn, walking away from every scene, and draws the map after it
+//parameters: game to play, action and steps as the console gives them
+static void PlayTurn(Game &world, int action, int steps) {
+  bool update = world.Act(action, steps);
+
+  for (int step = 0; world.scene.kind != NO_SCENE; step++) {
+    world.events.clear(); //shown
+    world.StepScene(world.scene.kind == MINIBOSS_SCENE ? "3" : (step % 2 ? "4" : "n"));
+  }
+  world.events.clear();
+  world.EndTurn(update);
+  for (int step = 0; world.scene.kind != NO_SCENE; step++) {
+    world.events.clear();
+    world.StepScene(world.scene.kind == MINIBOSS_SCENE ? "3" : (step % 2 ? "4" : "n"));
+  }
+  world.events.clear();
+  PrintGrid(world);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//marks the spot, travels to the nearest shop and back to the mark, then
+//walks on a bit so the next trip starts somewhere else
+//parameters: game to play, trips to make
+static void PlayTrips(Game &world, int trips) {
+  for (int i = 0; i < trips; i++) {
+    PlayTurn(world, 9, 1);
+    PlayTurn(world, 8, 1);
+    PlayTurn(world, 10, 1);
+    PlayTurn(world, i % 4, 5);
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//works out the miniboss odds at every health the player could be on, so the
+//memo of them is full before turns are counted and a miniboss coming into
+//sight doesnt look like a turn that allocates
+//parameter: game to warm
+static void WarmOdds(Game &world) {
+  Odds odds[3];
+  int health = world.player["health"];
+
+  for (int hp = 1; hp <= world.player["maxHP"]; hp++) {
+    world.player["health"] = hp;
+    world.MinibossOdds(odds);
+  }
+  world.player["health"] = health;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//runs every size asked for and prints one json array of the results
+//parameters: command line, sizes come after --sweep
+//returns the exit code
+static int Sweep(int argc, char *argv[]) {
+  std::vector<int> sizes;
+  for (int i = 2; i < argc; i++)
+    sizes.push_back(atoi(argv[i]));
+  if (sizes.empty()) {
+    int defaults[5] = {500, 1000, 2000, 4000, 8000};
+    sizes.assign(defaults, defaults + 5);
+  }
+
+  bool failed = false;
+  std::cout << "[\n";
+  for (long long unsigned int i = 0; i < sizes.size(); i++) {
+    if (i > 0)
+      std::cout << ",\n";
+    std::cerr << "Size " << sizes[i] << "...\n";
+    std::cout.flush(); //the child would print anything still buffered again
+
+#ifdef _WIN32
+    SweepSize(sizes[i]);
+#else
+    pid_t child = fork();
+    if (child == 0) {
+      SweepSize(sizes[i]);
+      std::cout.flush();
+      _exit(0);
+    }
+
+    int status = 0;
+    if (child < 0 || waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::cout << "  {\"size\": " << sizes[i] << ", \"error\": \"did not finish, out of memory or didnt load back in\"}";
+      failed = true;
+    }
+#endif
+  }
+  std::cout << "\n]\n";
+  return failed ? 1 : 0;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//times each part of the game on one size of map, with the peak memory after
+//each part. peaks only grow, so each parts cost is how much it added
+//parameter: blocks per side
+static void SweepSize(int size) {
+  static Game world;
+  NullBuffer null;
+  std::streambuf *console = std::cout.rdbuf();
+  std::chrono::steady_clock::time_point start;
+  double generate, indexes, miners, print, save, load;
+  long generateKb, indexesKb, minersKb, printKb, saveKb, loadKb;
+  long long unsigned int bytes;
+
+  OpenCounter(); //in the child, so it counts the childs misses
+  start = std::chrono::steady_clock::now();
+  world.Init(SEED, size);
+  generate = Seconds(start);
+  generateKb = MemoryKb(true);
+
+  start = std::chrono::steady_clock::now();
+  world.BuildIndexes();
+  indexes = Seconds(start);
+  indexesKb = MemoryKb(true);
+
+  CounterStart();
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 5; i++)
+    world.MoveMiners();
+  miners = Seconds(start) / 5;
+  long long missed = CounterStop();
+  minersKb = MemoryKb(true);
+
+  std::cout.rdbuf(&null);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 20; i++) {
+    world.fovValid = false;
+    PrintGrid(world);
+  }
+  print = Seconds(start) / 20;
+  std::cout.rdbuf(console);
+  printKb = MemoryKb(true);
+
+  {
+    std::ostringstream out;
+    start = std::chrono::steady_clock::now();
+    world.SaveGame(out);
+    save = Seconds(start);
+    saveKb = MemoryKb(true);
+
+    std::string text = out.str();
+    bytes = text.size();
+    std::istringstream in(text);
+    start = std::chrono::steady_clock::now();
+    if (!world.LoadGame(in)) {
+      std::cerr << "Size " << size << " didn't load back in\n";
+      exit(1);
+    }
+    load = Seconds(start);
+    loadKb = MemoryKb(true);
+  }
+
+  std::cout << std::fixed << std::setprecision(6);
+  const char *pageNames[4] = {"heap", "mapped", "huge", "reserved"};
+  std::cout << "  {\"size\": " << size << ", \"miners\": " << world.minerCount;
+  std::cout << ", \"pages\": \"" << pageNames[world.grid.pages] << "\"";
+  std::cout << ", \"tick_dtlb_misses\": " << (missed < 0 ? -1 : missed / 5);
+  std::cout << ", \"save_bytes\": " << bytes << ",\n   \"seconds\": {";
+  std::cout << "\"GenerateGrid\": " << generate << ", \"BuildIndexes\": " << indexes;
+  std::cout << ", \"MoveMiners\": " << miners << ", \"PrintGrid\": " << print;
+  std::cout << ", \"SaveGame\": " << save << ", \"LoadGame\": " << load << "},\n";
+  std::cout << "   \"peak_kb\": {";
+  std::cout << "\"GenerateGrid\": " << generateKb << ", \"BuildIndexes\": " << indexesKb;
+  std::cout << ", \"MoveMiners\": " << minersKb << ", \"PrintGrid\": " << printKb;
+  std::cout << ", \"SaveGame\": " << saveKb << ", \"LoadGame\": " << loadKb << "}}";
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//seconds since a time
+static double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//opens the dTLB miss counter for this process, it stays closed where perf
+//counters arent there or allowed
+static void OpenCounter() {
+#if defined(__linux__)
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  tlbCounter = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  if (tlbCounter < 0)
+    std::cerr << "No perf counters here, dTLB misses won't be counted\n";
+#endif
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//zeroes the counter and starts it
+static void CounterStart() {
+#if defined(__linux__)
+  if (tlbCounter >= 0) {
+    ioctl(tlbCounter, PERF_EVENT_IOC_RESET, 0);
+    ioctl(tlbCounter, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//stops the counter
+//returns misses since CounterStart, -1 without a counter
+static long long CounterStop() {
+#if defined(__linux__)
+  long long count = 0;
+  if (tlbCounter >= 0) {
+    ioctl(tlbCounter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(tlbCounter, &count, sizeof(count)) == sizeof(count))
+      return count;
+  }
+#endif
+  return -1;
+}
@@ -0,0 +1,293 @@
+//The Deep Below
+//the cave carving pass. each thread takes every so many bands of rows, packs
+//a band and the rows either side of it the rounds reach into, carves it on
+//its own and keeps the carved rows. the map is only written once every band
+//is carved, so no band ever reads rows another has already changed and the
+//caves come out the same however many threads there are
+
+
+#include "caves.h"
+#include "core.h"
+
+#include <thread>
+#include <vector>
+#include <functional>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+typedef unsigned long long Bits; //64 blocks of a row, block x is bit x % 64 of word x / 64
+
+static const Bits ALL = ~0ULL;
+static const int CAVE_HALO = CAVE_REACH + CAVE_ROUNDS; //rows either side of a band it needs
+static const Bits GOLDEN = 0x9e3779b97f4a7c15ULL; //steps the hash between words
+
+//a carve shared by every thread
+struct Carving {
+  World<unsigned char> *grid;
+  std::vector<Bits> flips; //1 for blocks the carve turns from dirt to open ground or back
+  unsigned int seed;
+  int  words;   //words a row
+  int  bands;   //bands of CAVE_BAND rows
+  int  threads; //thread t carves bands t, t + threads, ...
+};
+
+//one band packed into words, local row 0 is map row top
+struct Band {
+  int  top, rows;          //first row packed and rows packed
+  std::vector<Bits> solid; //1 for anything but open ground
+  std::vector<Bits> kept;  //1 for blocks the rule cant change, all but dirt and open ground
+  std::vector<Bits> mined; //1 for open ground before carving
+  std::vector<Bits> near;  //1 for blocks within CAVE_REACH of a cavern
+  std::vector<Bits> next;  //the round being worked out
+};
+
+//function prototypes
+static Bits Hash(Bits h);
+static void Spread(void (*work)(Carving &, int), Carving &carving);
+static void CarveBands(Carving &carving, int thread);
+static void WriteBands(Carving &carving, int thread);
+static void Pack(Carving &carving, Band &band);
+static void KnockOut(Carving &carving, Band &band);
+static void Round(Band &band, int words);
+static void Across(const Bits *row, int w, int words, Bits &low, Bits &high);
+
+
+//carves caves out around the caverns of a newly made map. only dirt and open
+//ground change, everything else counts as solid rock
+//parameters: the map, seed it was made from, threads to carve on, 0 for one
+//per core
+void CarveCaves(World<unsigned char> &grid, unsigned int seed, int threads) {
+  Carving carving;
+  carving.grid = &grid;
+  carving.seed = seed;
+  carving.words = (grid.size + 63) / 64;
+  carving.bands = (grid.size + CAVE_BAND - 1) / CAVE_BAND;
+  carving.flips.assign((long long)grid.size * carving.words, 0);
+
+  if (threads <= 0)
+    threads = std::thread::hardware_concurrency();
+  carving.threads = std::max(1, std::min(threads, carving.bands));
+
+  Spread(CarveBands, carving);
+  Spread(WriteBands, carving);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//splitmix64, turns a spot into 64 random bits
+//parameter: the spot and seed mixed together
+//returns the bits
+static Bits Hash(Bits h) {
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//runs a piece of the carve on every thread and waits for them all
+//parameters: the piece, given the carve and which thread it is, and the carve
+static void Spread(void (*work)(Carving &, int), Carving &carving) {
+  std::vector<std::thread> pool;
+  for (int t = 1; t < carving.threads; t++)
+    pool.push_back(std::thread(work, std::ref(carving), t));
+  work(carving, 0);
+  for (long long unsigned int i = 0; i < pool.size(); i++)
+    pool[i].join();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//carves a threads bands, keeping which blocks of their rows change
+//parameters: the carve and which thread this is
+static void CarveBands(Carving &carving, int thread) {
+  int words = carving.words;
+  Band band;
+
+  for (int b = thread; b < carving.bands; b += carving.threads) {
+    int first = b * CAVE_BAND;
+    int last = std::min(first + CAVE_BAND, carving.grid->size);
+    band.top = std::max(0, first - CAVE_HALO);
+    band.rows = std::min(carving.grid->size, last + CAVE_HALO) - band.top;
+
+    Pack(carving, band);
+    KnockOut(carving, band);
+    for (int r = 0; r < CAVE_ROUNDS; r++)
+      Round(band, words);
+
+    //the halo rows are off by a row a round from the edge in, the bands own
+    //rows are exact
+    for (int y = first; y < last; y++) {
+      long long at = (long long)(y - band.top) * words;
+      Bits *flips = &carving.flips[(long long)y * words];
+      for (int w = 0; w < words; w++, at++)
+        flips[w] = (~band.solid[at] & ~band.kept[at]) ^ band.mined[at];
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//makes the changes to a threads bands in the map
+//parameters: the carve and which thread this is
+static void WriteBands(Carving &carving, int thread) {
+  World<unsigned char> &grid = *carving.grid;
+  int words = carving.words;
+
+  for (int b = thread; b < carving.bands; b += carving.threads) {
+    int last = std::min((b + 1) * CAVE_BAND, grid.size);
+
+    for (int y = b * CAVE_BAND; y < last; y++) {
+      unsigned char *row = grid[y];
+      const Bits *flips = &carving.flips[(long long)y * words];
+
+      for (int w = 0; w < words; w++) {
+        for (Bits bits = flips[w]; bits != 0; bits &= bits - 1) {
+          int x = w * 64 + __builtin_ctzll(bits);
+          row[x] = row[x] == MINED ? DIRT : MINED;
+        }
+      }
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//packs a bands rows out of the map
+//parameters: the carve and the band, its top and rows set
+static void Pack(Carving &carving, Band &band) {
+  World<unsigned char> &grid = *carving.grid;
+  int words = carving.words;
+  long long cells = (long long)band.rows * words;
+
+  band.solid.resize(cells);
+  band.kept.resize(cells);
+  band.mined.resize(cells);
+  band.near.resize(cells);
+  band.next.resize(cells);
+
+  for (int i = 0; i < band.rows; i++) {
+    const unsigned char *row = grid[band.top + i];
+
+    for (int w = 0; w < words; w++) {
+      Bits mined = 0, loose = 0;
+      int width = std::min(64, grid.size - w * 64);
+      int b = 0;
+#ifdef __SSE2__
+      //16 blocks at a time, a compare and a movemask give a bit each
+      for (; b + 16 <= width; b += 16) {
+        __m128i blocks = _mm_loadu_si128((const __m128i*)(row + w * 64 + b));
+        Bits isMined = _mm_movemask_epi8(_mm_cmpeq_epi8(blocks, _mm_set1_epi8(MINED)));
+        Bits isDirt = _mm_movemask_epi8(_mm_cmpeq_epi8(blocks, _mm_set1_epi8(DIRT)));
+        mined |= isMined << b;
+        loose |= (isMined | isDirt) << b;
+      }
+#endif
+      for (; b < width; b++) {
+        mined |= (Bits)(row[w * 64 + b] == MINED) << b;
+        loose |= (Bits)(row[w * 64 + b] == MINED || row[w * 64 + b] == DIRT) << b;
+      }
+
+      long long at = (long long)i * words + w;
+      band.solid[at] = ~mined;
+      band.kept[at] = ~loose; //past the end of the row too
+      band.mined[at] = mined;
+      band.near[at] = mined;
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//knocks out about 7 in 16 of the dirt blocks near a cavern, the rounds then
+//join them up into caves off the cavern or fill them back in
+//parameters: the carve and the packed band
+static void KnockOut(Carving &carving, Band &band) {
+  int words = carving.words;
+
+  //spreads the caverns a block up, down and to each side at a time
+  for (int step = 0; step < CAVE_REACH; step++) {
+    for (int i = 0; i < band.rows; i++) {
+      const Bits *row = &band.near[(long long)i * words];
+      const Bits *up = i > 0 ? row - words : NULL;
+      const Bits *down = i + 1 < band.rows ? row + words : NULL;
+      Bits *next = &band.next[(long long)i * words];
+
+      for (int w = 0; w < words; w++) {
+        Bits spread = row[w] | row[w] << 1 | row[w] >> 1;
+        if (w > 0)
+          spread |= row[w - 1] >> 63;
+        if (w + 1 < words)
+          spread |= row[w + 1] << 63;
+        if (up != NULL)
+          spread |= up[w];
+        if (down != NULL)
+          spread |= down[w];
+        next[w] = spread;
+      }
+    }
+    band.near.swap(band.next);
+  }
+
+  for (int i = 0; i < band.rows; i++) {
+    Bits key = Hash(((Bits)carving.seed << 32 | (unsigned int)(band.top + i)) * GOLDEN);
+    long long at = (long long)i * words;
+
+    for (int w = 0; w < words; w++, at++) {
+      if ((band.near[at] & ~band.kept[at]) == 0)
+        continue; //nothing here to knock out, most of the map
+      Bits a = Hash(key + (4 * w + 1) * GOLDEN);
+      Bits b = Hash(key + (4 * w + 2) * GOLDEN);
+      Bits c = Hash(key + (4 * w + 3) * GOLDEN);
+      Bits d = Hash(key + (4 * w + 4) * GOLDEN);
+      band.solid[at] &= ~(band.near[at] & ~band.kept[at] & a & (b | c | d));
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//one round of the 4-5 rule. a block is solid next round when 5 or more of
+//the 9 blocks around and on it are, which is dirt staying with 4 solid
+//neighbours and open ground filling in with 5. rows past the band are solid
+//parameters: the packed band and words a row
+static void Round(Band &band, int words) {
+  std::vector<Bits> rock(words, ALL); //a solid row for past either end
+
+  for (int i = 0; i < band.rows; i++) {
+    const Bits *row = &band.solid[(long long)i * words];
+    const Bits *up = i > 0 ? row - words : rock.data();
+    const Bits *down = i + 1 < band.rows ? row + words : rock.data();
+    const Bits *kept = &band.kept[(long long)i * words];
+    Bits *next = &band.next[(long long)i * words];
+
+    for (int w = 0; w < words; w++) {
+      Bits a0, a1, b0, b1, c0, c1;
+      Across(up, w, words, a0, a1);
+      Across(row, w, words, b0, b1);
+      Across(down, w, words, c0, c1);
+
+      //adds the three rows, each 0 to 3 as a low and high bit. the low bits
+      //leave a 1 and carry a 2, which joins the three high bits as twos
+      Bits ones = a0 ^ b0 ^ c0;
+      Bits carry = (a0 & b0) | (c0 & (a0 ^ b0));
+      Bits p = a1 ^ b1, q = a1 & b1; //the twos as one 2 and one 4
+      Bits r = c1 ^ carry, t = c1 & carry;
+      Bits threeTwos = (q & t) | ((q | t) & (p | r));
+      Bits twoTwos = q | t | (p & r);
+
+      next[w] = threeTwos | (twoTwos & ones) | kept[w];
+    }
+  }
+  band.solid.swap(band.next);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//counts each block and its left and right neighbours, for 64 blocks at once
+//counts past either end of the row as solid
+//parameters: packed row, which word, words a row, where the count goes as its
+//low and high bit
+static void Across(const Bits *row, int w, int words, Bits &low, Bits &high) {
+  Bits middle = row[w];
+  Bits left = middle << 1 | (w > 0 ? row[w - 1] : ALL) >> 63;
+  Bits right = middle >> 1 | (w + 1 < words ? row[w + 1] : ALL) << 63;
+
+  low = left ^ middle ^ right;
+  high = (left & middle) | (right & (left ^ middle));
+}
@@ -0,0 +1,21 @@
+//The Deep Below
+//opens the caverns the noise makes up into caves. the dirt around each
+//cavern is knocked out at random, then a few rounds of the 4-5 rule are
+//run over it: dirt stays dirt with 4 or more solid blocks around it and
+//open ground fills in with 5 or more. the rule runs on rows packed 64 blocks
+//to a word, counting neighbours with shifted words and bitwise adders, on
+//bands of rows spread over threads
+
+#ifndef CAVES_H
+#define CAVES_H
+
+#include "world.h"
+
+
+static const int CAVE_ROUNDS = 5; //rounds of the 4-5 rule
+static const int CAVE_REACH = 4;  //blocks out from a cavern the dirt is knocked out
+static const int CAVE_BAND = 256; //rows a thread carves at a time
+
+void CarveCaves(World<unsigned char> &grid, unsigned int seed, int threads);
+
+#endif
@@ -0,0 +1,633 @@
+//The Deep Below
+//console front end, draws the mines and tells the player what happened
+
+
+#include "console.h"
+#include "profile.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <limits>
+
+#ifdef   _WIN32
+#include <Windows.h>
+#include <conio.h>
+#else    //linux
+#include <unistd.h>
+#include <sys/select.h>
+#endif
+
+
+//function prototypes
+static void PrintMinimap(Game &world, int level, int top, int left, int size);
+static bool SaveFile(Game &world, std::string name);
+static bool LoadFile(Game &world, std::string name);
+static bool Wait(double seconds);
+
+bool fastText = false; //true to play scenes without pausing
+
+
+
+//prints blocks around the player
+void PrintGrid(Game &world) {
+  ProfileScope scope(PRINT_PHASE);
+  std::cout << "\n\n\n\n\n\n";
+  int y, x, chance, sight;
+  bool monster = false;
+  sight = world.upgrades[1] + 4;
+
+  world.UpdateFov(sight);
+
+  //the edge band shows up blank, so the view never has to be clamped
+  std::pmr::string line(&world.scratch);
+  line.reserve(4 * sight + 3);
+  for (y = world.player["y"] - sight; y < world.player["y"] + sight + 1; y++) {
+    line.clear();
+    for (x = world.player["x"] - sight; x < world.player["x"] + sight + 1; x++) {
+      int block = world.IsVisible(y, x) ? world.grid[y][x] : MINED; //hidden behind rock
+      char glyph = GLYPH[block];
+
+      if (block == ORE || block == ARTIFACT) { //ore and artifact have chance of not showing up
+        chance = rand() % (8 - (world.upgrades[4]*2)); //chance goes from 1/8 to 1/6
+        if (chance == 0)       //to 1/4 to 1/2 chance of showing up on the map
+          glyph = '*';
+      }
+      else if (block == MINIBOSS)
+        monster = true;
+
+      line += glyph;
+      line += ' ';
+    } //end for x
+    line += '\n';
+    std::cout << line;
+  } //end for y
+
+  std::cout << "Ore: " << world.player["ore"] << "  Artifacts: " << world.player["artifacts"];
+  std::cout << "  Coins: " << world.player["coins"] << "  HP: " << world.player["health"] << '\n';
+
+  int shopY, shopX, bossY, bossX, distance;
+
+  //compasses to the closest shop and miniboss
+  distance = world.NearestLandmark(0, world.player["y"], world.player["x"], shopY, shopX);
+  if (distance != -1) {
+    std::cout << "Nearest shop: " << distance << " blocks ";
+    std::cout << world.Compass(world.player["y"], world.player["x"], shopY, shopX) << '\n';
+  }
+
+  distance = world.NearestLandmark(1, world.player["y"], world.player["x"], bossY, bossX);
+  if (distance != -1) {
+    std::cout << "Nearest miniboss: " << distance << " blocks ";
+    std::cout << world.Compass(world.player["y"], world.player["x"], bossY, bossX) << '\n';
+  }
+
+  //sizes up a miniboss in sight before walking into it
+  if (monster) {
+    Odds odds[3];
+    world.MinibossOdds(odds);
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "Miniboss odds: attack " << odds[0].win * 100 << "% win (" << odds[0].hp << " HP)";
+    std::cout << "  defend " << odds[1].win * 100 << "% win (" << odds[1].hp << " HP)";
+    std::cout << "  run " << odds[2].escape * 100 << "% away (" << odds[2].hp << " HP)\n";
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+  }
+
+  if (world.upgrades[6] == 3) {
+    std::string direction = world.Compass(world.player["y"], world.player["x"], world.player["bossY"], world.player["bossX"]);
+
+    if (world.player["y"] >= world.player["bossY"])
+      y = world.player["y"] - world.player["bossY"];
+    else
+      y = world.player["bossY"] - world.player["y"];
+
+    if (world.player["x"] >= world.player["bossX"])
+      x = world.player["x"] - world.player["bossX"];
+    else
+      x = world.player["bossX"] - world.player["x"];
+    
+    if (!(y < 7 && x < 7))
+      std::cout << "Your cursed compass points " << direction << '\n';
+    else
+      std::cout << "Your cursed compass begins spinning in all directions\n";
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//grabs player input and returns
+//parameter: set to how many steps a move should take
+int GameInput(int &steps) {
+  ProfileScope scope(INPUT_PHASE);
+  char input;
+  InputClear();
+  input = getchar();
+
+  //a count or * in front of a move runs that many steps, * runs until something turns up
+  steps = 1;
+  if (input == '*') {
+    steps = RUN_LIMIT;
+    input = getchar();
+  }
+  else if (input >= '0' && input <= '9') {
+    steps = 0;
+    while (input >= '0' && input <= '9') {
+      if (steps < RUN_LIMIT)
+        steps = steps * 10 + (input - '0');
+      input = getchar();
+    }
+    if (steps > RUN_LIMIT)
+      steps = RUN_LIMIT;
+  }
+
+  switch (input) {
+    case 'w':
+    case 'W':
+      return 0;
+    case 'a':
+    case 'A':
+      return 1;
+    case 's':
+    case 'S':
+      return 2;
+    case 'd':
+    case 'D':
+      return 3;
+    case 'h':
+    case 'H':
+      return 4;
+    case 't':
+    case 'T':
+      return 5;
+    case 'p':
+    case 'P':
+      return 6;
+    case 'm':
+    case 'M':
+      return 7;
+    case 'g':
+    case 'G':
+      return 8;
+    case 'k':
+    case 'K':
+      return 9;
+    case 'r':
+    case 'R':
+      return 10;
+    case 'f':
+    case 'F':
+      return 11;
+    case '`': //frame stats, not on the help screen
+      return 12;
+    default:
+      return -1;
+  } //end switch
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//prints the memory each part of the game holds and what the process held
+//along the way
+void MemoryReport(Game &world) {
+  std::vector<MemoryPart> parts;
+  long long total = 0;
+
+  world.MemoryUse(parts);
+  std::cout << "\nGame memory               kB\n";
+  for (long long unsigned int i = 0; i < parts.size(); i++) {
+    total += parts[i].bytes;
+    std::cout << std::left << std::setw(18) << parts[i].name << std::right;
+    std::cout << std::setw(10) << (parts[i].bytes + 1023) / 1024 << "  " << parts[i].note << '\n';
+  }
+  std::cout << std::left << std::setw(18) << "Total" << std::right << std::setw(10) << (total + 1023) / 1024 << "\n\n";
+  MemoryMarks(std::cout);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//processes final game statistics
+void GameReport(Game &world) { 
+  std::cout << "\n\nGame Over!\n";
+  int upg = 0;
+  int score = world.Score();
+
+  for (int i = 0; i < UPGRADE_UPPER; i++) {
+    if (world.upgrades[i] > 0)
+      upg += world.upgrades[i];
+  }
+
+  std::cout << "Total Score:      " << score << "\n\n";
+  MySleep(1);
+
+  std::cout << "Dirt:             " << world.player["dirt"] << '\n';
+  MySleep(1);
+
+  std::cout << "Ore:              " << world.player["ore"] << '\n';
+  MySleep(1);
+
+  std::cout << "Artifacts:        " << world.player["artifacts"] << '\n';
+  MySleep(1);
+
+  std::cout << "Coins:            " << world.player["coins"] << '\n';
+  MySleep(1);
+
+  std::cout << "Upgrades aquired: " << upg << '\n';
+  MySleep(1);
+
+  std::cout << "Miners slayed:    " << world.player["kills"] << '\n';
+  MySleep(1);
+
+  std::cout << "Mines explored:   " << world.exploredCount * 100 / ((long long)world.gridUpper * world.gridUpper);
+  std::cout << "%\n\n";
+  MySleep(1);
+
+  //whats left down there
+  std::cout << "Ore left behind:       " << world.CountResource(0, 0, 0, world.gridUpper-1, world.gridUpper-1) << '\n';
+  std::cout << "Artifacts left behind: " << world.CountResource(1, 0, 0, world.gridUpper-1, world.gridUpper-1) << '\n';
+  std::cout << "Miners still digging:  " << world.CountResource(2, 0, 0, world.gridUpper-1, world.gridUpper-1) << "\n\n";
+  MySleep(1);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//introduces game mechanics
+void Intro(Game &world) {
+  int x;
+  std::cout << "\nHello... You're finally awake.\nI have kept you safe this long but ";
+  std::cout << "you must continue this journey on your own.\n\n";
+  std::cout << "I have blessed you with an upgrade... carry it well.\n";
+  x = world.Rand() % UPGRADE_UPPER;
+  world.Upgrade(x);
+  
+  std::cout << "The Deep Below is endless, so mine to your heart's content.\n";
+  std::cout << "And beware of others... you aren't alone down here.\n\n";
+  std::cout << "Press any key to begin.\n";
+  std::cin >> x;
+
+  std::cout << "\n\nControls: \n   Enter WASD to move\n";
+  MySleep(2);
+  std::cout << "   Put a number before a move to take that many steps, like 20D\n";
+  std::cout << "   or * to keep digging until something turns up, like *D\n";
+  MySleep(2);
+  std::cout << "   Enter H to hold your ground\n";
+  MySleep(2);
+  std::cout << "   Enter P to prospect the rock around you\n";
+  MySleep(2);
+  std::cout << "   Enter M to look at your map\n";
+  MySleep(2);
+  std::cout << "   Enter G to travel to the nearest shop\n";
+  MySleep(2);
+  std::cout << "   Enter K to mark a spot and R to travel back to it\n";
+  MySleep(2);
+  std::cout << "   Enter F to hurry through conversations and fights\n";
+  MySleep(2);
+  std::cout << "   Enter T to go to the title screen\n";
+  MySleep(2);
+  std::cout << "\nGood Luck Mining!";
+  MySleep(4);
+
+  PrintGrid(world);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//saves a lot of typing the ifdef else every time
+void MySleep(double seconds) {
+  #ifdef _WIN32
+  seconds *= 1000;
+  Sleep(seconds);
+
+  #else
+  seconds = (int)seconds;
+  sleep(seconds);
+  #endif
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//allows the player to explore options outside of the game
+bool TitleScreen(Game &world) {
+  char input;
+  int upg = 0;
+
+  std::cout << "\n\n\n\n\n\n\n\nThe Deep Below\n\nTitle Screen:\n";
+  std::cout << "1. Resume Game\n";
+  std::cout << "2. Save Game\n";
+  std::cout << "3. Load Game\n";
+  std::cout << "4. View Stats\n";
+  std::cout << "5. Exit Game\n";
+  std::cout << "6. View Credits\n";
+  std::cout << "What would you like to do? Enter the number.\n";
+
+  InputClear();
+  std::cin >> input;
+  input -= 1;
+
+  switch (input) {
+    case '0': //resume game
+      return true;
+
+    case '1': //save game
+      std::cout << "Saving...\n";
+      MySleep(1);
+      SaveFile(world, "save.txt");
+      return false;
+
+    case '2': //load game
+      std::cout << "After loading, press any key to begin.\n";
+      MySleep(1);
+      LoadFile(world, "save.txt");
+      return false;
+
+    case '3': //view stats
+      //print upgrades
+      for (int i = 0; i < UPGRADE_UPPER; i++) {
+        if (world.upgrades[i] > 0) {
+          upg += world.upgrades[i];
+        }
+      }
+
+      //print stats
+      std::cout << "Dirt:             " << world.player["dirt"] << '\n';
+      MySleep(1);
+      std::cout << "Upgrades aquired: " << upg << '\n';
+      MySleep(1);
+      std::cout << "Miners slayed:    " << world.player["kills"] << "\n\n";
+      MySleep(4);
+      return false;
+
+    case '4': //exit game
+      world.game = false;
+      return false;
+
+    case '5': //view credits
+      std::cout << "\nWell my, my, my, thank you for asking!\n\n";
+      MySleep(1);
+      std::cout << "This was developed solely by Luka Brown!\n";
+      MySleep(2);
+      std::cout << "They are a software developer currently based in Texas and";
+      std::cout << " working on finishing a Computer Science degree in '23!\n\n";
+      MySleep(7);
+      return false;
+
+    default:
+      std::cout << "Invalid Input\n";
+      MySleep(2);
+      return false;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//clears input, is called before any cin
+void InputClear() {
+  std::cin.clear();
+  std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//player listens to the rock and learns what is buried in each direction
+void Prospect(Game &world) {
+  const char *names[4] = {"North", "South", "West ", "East "};
+  int y = world.player["y"];
+  int x = world.player["x"];
+  int r = PROSPECT_RANGE;
+
+  //rectangles for north, south, west and east of the player
+  int areas[4][4] = {{y-r, x-r, y-1, x+r},
+                     {y+1, x-r, y+r, x+r},
+                     {y-r, x-r, y+r, x-1},
+                     {y-r, x+1, y+r, x+r}};
+
+  std::cout << "\nYou press your ear to the rock and listen to the mines around you...\n";
+  MySleep(2);
+
+  for (int i = 0; i < 4; i++) {
+    std::cout << names[i] << "  Ore: " << world.CountResource(0, areas[i][0], areas[i][1], areas[i][2], areas[i][3]);
+    std::cout << "  Artifacts: " << world.CountResource(1, areas[i][0], areas[i][1], areas[i][2], areas[i][3]);
+    std::cout << "  Miners: " << world.CountResource(2, areas[i][0], areas[i][1], areas[i][2], areas[i][3]) << '\n';
+  }
+
+  MySleep(4);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//shows the whole mines and then the area around the player
+void Minimap(Game &world) {
+  int tunnels = 0;
+  int side = (world.gridUpper + MIP_SCALE[MIP_LEVELS-1] - 1) / MIP_SCALE[MIP_LEVELS-1];
+  char input;
+
+  //the coarsest level is small enough to total up directly
+  for (int i = 0; i < side * side; i++)
+    tunnels += world.pyramid[MIP_LEVELS-1][0][i];
+
+  std::cout << "\n\nYou unfold your map of The Deep Below.\n";
+  std::cout << "Dug out: " << (long long)tunnels * 100 / ((long long)world.gridUpper * world.gridUpper);
+  std::cout << "%   (# rock  . tunnels  $ known shop  1-9 miners  P you)\n\n";
+
+  //the finest level that fits the whole mines in a panel, past the coarsest
+  //the panel grows instead
+  int level = 1;
+  int overview = (world.gridUpper + MIP_SCALE[level] - 1) / MIP_SCALE[level];
+  while (level < MIP_LEVELS-1 && overview > MINIMAP_SIZE) {
+    level++;
+    overview = (world.gridUpper + MIP_SCALE[level] - 1) / MIP_SCALE[level];
+  }
+  PrintMinimap(world, level, 0, 0, overview > MINIMAP_SIZE ? overview : MINIMAP_SIZE);
+
+  //finest level, centered on the player
+  int top = world.player["y"] / MIP_SCALE[0] - MINIMAP_SIZE/2;
+  int left = world.player["x"] / MIP_SCALE[0] - MINIMAP_SIZE/2;
+  std::cout << "\nUp close:\n";
+  PrintMinimap(world, 0, top, left, MINIMAP_SIZE);
+
+  std::cout << "\nEnter any key to put the map away.\n";
+  InputClear();
+  std::cin >> input;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//prints a square of minimap summaries, two characters per summary
+//the first shows how dug out it is and the second what is inside
+//parameters: pyramid level, top left summary co-ord. and panel size
+static void PrintMinimap(Game &world, int level, int top, int left, int size) {
+  int scale = MIP_SCALE[level];
+  int side = (world.gridUpper + scale - 1) / scale;
+  int area, index, miners;
+
+  //keeps the panel on the map
+  if (top > side - size)
+    top = side - size;
+  if (left > side - size)
+    left = side - size;
+  if (top < 0)
+    top = 0;
+  if (left < 0)
+    left = 0;
+
+  for (int y = top; y < top + size && y < side; y++) {
+    for (int x = left; x < left + size && x < side; x++) {
+      index = y * side + x;
+      area = scale * scale;
+
+      //how much of the summary has been dug out
+      if (world.pyramid[level][0][index] * 20 < area)
+        std::cout << '#';
+      else if (world.pyramid[level][0][index] * 4 < area)
+        std::cout << ':';
+      else
+        std::cout << '.';
+
+      //only shops the player has seen get marked
+      miners = world.pyramid[level][2][index];
+      if (world.player["y"] / scale == y && world.player["x"] / scale == x)
+        std::cout << 'P';
+      else if (world.pyramid[level][3][index] > 0)
+        std::cout << '$';
+      else if (miners > 9)
+        std::cout << '9';
+      else if (miners > 0)
+        std::cout << miners;
+      else
+        std::cout << ' ';
+    }
+    std::cout << '\n';
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//shows everything the game has left in its events, and asks the player
+//until any scene is over. answers typed ahead are used as they come, and
+//any key skips the pauses left
+//parameter: game to show
+void ShowEvents(Game &world) {
+  bool skip = false;
+
+  while (true) {
+    for (long long unsigned int i = 0; i < world.events.size(); i++) {
+      const Event &event = world.events[i];
+      double seconds = event.seconds;
+
+      switch (event.type) {
+        case SAY_EVENT:
+          std::cout << event.text;
+          break;
+        case ORE_EVENT:
+          std::cout << "\nWhile digging, you found a rare ore!" << '\n';
+          seconds = 2;
+          break;
+        case ARTIFACT_EVENT:
+          std::cout << "\nWhile digging, you found an ancient artifact!" << '\n';
+          seconds = 2;
+          break;
+        case HIT_EVENT:
+          std::cout << "\nYou spot a miner coming toward you and see a haze in their eyes.\n";
+          std::cout << "\nThey don't seem to notice you and continue swinging their pickaxe";
+          std::cout << " even though you are in their way.\n";
+          std::cout << "You brace and take " << event.value << " damage from the miner.\n\n";
+          seconds = 4;
+          break;
+        case SLAIN_EVENT:
+          std::cout << "You've taken too much damage and the miner is merciless.\n";
+          std::cout << "You fall to the ground and the miner continues on their way.\n";
+          seconds = 5;
+          break;
+        case TRAVEL_EVENT:
+          std::cout << "You set off, " << event.value << " blocks to go.\n";
+          seconds = 1;
+          break;
+        case NO_PATH_EVENT:
+          std::cout << "You can't find a way there. Something is in the way.\n";
+          seconds = 2;
+          break;
+        case STOPPED_EVENT:
+          std::cout << "Something stops you in your tracks.\n";
+          seconds = 2;
+          break;
+        case SPOTTED_EVENT:
+          std::cout << "Something catches your eye.\n";
+          seconds = 1;
+          break;
+        case MARK_EVENT:
+          std::cout << "You scratch a mark into the rock.\n";
+          seconds = 2;
+          break;
+        case NO_MARK_EVENT:
+          std::cout << "You haven't made a mark yet.\n";
+          seconds = 2;
+          break;
+      }
+
+      std::cout << std::flush;
+      if (!skip && !fastText && seconds > 0)
+        skip = Wait(seconds);
+    }
+    world.events.clear();
+
+    if (world.scene.kind == NO_SCENE)
+      return;
+
+    std::string answer;
+    if (!(std::cin >> answer)) {
+      std::cin.clear();
+      answer = "";
+    }
+    world.StepScene(answer);
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//saves the game to a file
+//parameters: game to save and the file name
+static bool SaveFile(Game &world, std::string name) {
+  std::ofstream MyFile(name);
+
+  if (!MyFile || !world.SaveGame(MyFile)) {
+    std::cerr << "Error opening/writing/closing file\n";
+    MySleep(2);
+    return false;
+  }
+
+  std::cout << "Save Successful!\n";
+  MySleep(2);
+  return true;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//loads a game from a file
+//parameters: game to load into and the file name
+static bool LoadFile(Game &world, std::string name) {
+  InputClear();
+  std::ifstream MyFile(name);
+
+  if (!MyFile || !world.LoadGame(MyFile)) {
+    std::cerr << "Error opening/reading/closing file, the game goes on as it was\n";
+    MySleep(2);
+    return false;
+  }
+
+  MemoryMark("After load");
+  std::cout << "Load Successful!\n";
+  MySleep(2);
+  return true;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//waits unless the player starts typing
+//parameter: seconds to wait
+//returns true if the wait was cut short by a key
+static bool Wait(double seconds) {
+  #ifdef _WIN32
+  for (double waited = 0; waited < seconds; waited += 0.05) {
+    if (_kbhit())
+      return true;
+    Sleep(50);
+  }
+  return false;
+
+  #else
+  fd_set keys;
+  FD_ZERO(&keys);
+  FD_SET(STDIN_FILENO, &keys);
+
+  timeval timeout;
+  timeout.tv_sec = (int)seconds;
+  timeout.tv_usec = (int)((seconds - (int)seconds) * 1000000);
+  return select(STDIN_FILENO + 1, &keys, NULL, NULL, &timeout) > 0;
+  #endif
+}
@@ -0,0 +1,29 @@
+//The Deep Below
+//console front end, reads the keyboard and prints the mines and the events
+//a Game leaves behind
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "core.h"
+
+extern bool fastText; //true to play scenes without pausing
+
+//intro/helper functions
+void Intro(Game &world);
+void InputClear();
+void MySleep(double seconds);
+
+//game functions
+int  GameInput(int &steps);
+void ShowEvents(Game &world);
+void GameReport(Game &world);
+void MemoryReport(Game &world);
+bool TitleScreen(Game &world);
+
+//map/grid functions
+void PrintGrid(Game &world);
+void Prospect(Game &world);
+void Minimap(Game &world);
+
+#endif
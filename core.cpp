@@ -0,0 +1,3268 @@
+//The Deep Below
+//simulation core, the rules of the mines with no input or output
+
+
+#include "core.h"
+#include "profile.h"
+#include "noise.h"
+#include "caves.h"
+
+#include <istream>
+#include <ostream>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
+
+//a save read and checked, waiting to be put into the game
+struct SaveData {
+  World<unsigned char> grid;
+  std::map<std::string, int> player;
+  int  upgrades[UPGRADE_UPPER];
+  std::vector<Rogue> miners; //the living, timers not set yet
+  std::vector<int> waits;    //turns each miner waits before it next moves
+  std::string explored;      //explored line, empty if the save has none
+  std::string shops;         //shops line, empty if the save has none
+};
+
+static bool ReadSave(std::istream &MyFile, SaveData &save);
+
+//creates 2d vector of blocks
+void Game::GenerateGrid() {
+  ProfileScope scope(GENERATE_PHASE);
+  int y, x;
+  int minerNum = 0;
+
+  //initializes map with the blocks the noise makes, about .3% shops, 1.3%
+  //ore in veins, .8% artifacts in pockets, .02% minibosses, .15% miners and
+  //4% caverns already mined out, 5% once the caves are carved
+  for (y = 0; y < gridUpper; y++) {
+    NoiseRow(mapSeed, y, 0, gridUpper, grid[y]);
+
+    for (x = 0; x < gridUpper; x++) {
+      if (grid[y][x] == MINIBOSS) {
+        //wont let miniboss spawn near spawn
+        if ((y < gridUpper/2 + gridUpper/100 && y > gridUpper/2 - gridUpper/100) &&
+            (x < gridUpper/2 + gridUpper/100 && x > gridUpper/2 - gridUpper/100))
+          grid[y][x] = DIRT;
+      }
+
+      else if (grid[y][x] == MINER) {
+        minerNum++;
+
+        //ensures not in player spawn and not too many miners
+        if (minerNum > minerCount || (y == gridUpper/2 && x == gridUpper/2)) {
+          grid[y][x] = DIRT;
+        }
+        else {
+          Rogue miner;
+          InitMiner(miner, y, x);
+          MinerList.push_back(miner);
+        }
+      }
+    } //end for x
+  } //end for y
+
+  //opens the caverns up into caves
+  CarveCaves(grid, mapSeed, carveThreads);
+  
+  //ensures enough miners
+  for (int i = minerNum; i < minerCount; i++) { 
+    y = Rand() % gridUpper;
+    x = Rand() % gridUpper;
+
+    //ensures not in player spawn
+    while (y == gridUpper/2 && x == gridUpper/2) { 
+      y = Rand() % gridUpper;
+      x = Rand() % gridUpper;
+    }
+
+    Rogue miner;
+    InitMiner(miner, y, x);
+    MinerList.push_back(miner);
+    grid[y][x] = MINER;
+  }
+
+  //spawns boss
+  y = Rand() % gridUpper;
+  x = Rand() % gridUpper;
+
+  //ensures boss is not anywhere in a 500x500 square around spawn
+  while ((x < gridUpper/2 + gridUpper/8 && x > gridUpper/2 - gridUpper/8) ||
+         (y < gridUpper/2 + gridUpper/8 && y > gridUpper/2 - gridUpper/8)) {
+    y = Rand() % gridUpper;
+    x = Rand() % gridUpper;
+  }
+
+  grid[y][x] = BOSS; //sets boss position
+  player["bossY"] = y; //used for cursed compass upgrade
+  player["bossX"] = x; //used for cursed compass upgrade
+  
+  //sets player position
+  grid[player["y"]][player["x"]] = PLAYER; 
+
+  //new map, nothing seen yet
+  explored.assign(gridUpper * exploredWords, 0);
+  exploredCount = 0;
+
+  BuildIndexes(); //counts resources and finds landmarks
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//adjusts players position on map based on keypress
+//parameter: int 1,2,3 or 4 of which direction to move player in
+void Game::Move(int direction) {
+  ProfileScope scope(MOVE_PHASE);
+  const int stepY[4] = {-1, 0, 1, 0};
+  const int stepX[4] = {0, -1, 0, 1};
+
+  if (direction < 0 || direction > 3)
+    return;
+
+  //the edge band turns the player back, so there are no bounds to check
+  int y = player["y"] + stepY[direction];
+  int x = player["x"] + stepX[direction];
+  if (CollectItem(y, x)) { //processes block stepped on
+    SetBlock(y, x, PLAYER);
+    SetBlock(player["y"], player["x"], MINED);
+    player["y"] = y;
+    player["x"] = x;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//processes block player stepped on, but before that it checks the upgrades
+//and processes those blocks first. from the upgraded mine the player can only
+//gain ore and artifacts
+//parameters: YX co-ord. of the item to be collected by player
+bool Game::CollectItem(int y, int x) {
+  ProfileScope scope(COLLECT_PHASE);
+
+  //blocks the digging upgrades take along with the one stepped into, as
+  //{ahead, beside} of it: both upgraded, just depth, just width
+  static const int shapes[3][8][2] = {{{0, -1}, {1, -1}, {2, -1}, {1, 0}, {2, 0}, {0, 1}, {1, 1}, {2, 1}},
+                                      {{1, 0}, {2, 0}},
+                                      {{0, -1}, {0, 1}}};
+  static const int shapeSize[3] = {8, 2, 2};
+
+  //gets direction of travel for upgrade processing
+  int aheadY = 0, aheadX = 0;
+  if (player["x"] != x)
+    aheadX = player["x"] > x ? -1 : 1;
+  else if (player["y"] != y)
+    aheadY = player["y"] > y ? -1 : 1;
+
+  int shape = -1;
+  if (upgrades[2] == 3 && upgrades[3] == 3) //if upgraded depth & width
+    shape = 0;
+  else if (upgrades[2] == 3) //just depth upgraded
+    shape = 1;
+  else if (upgrades[3] == 3) //just width upgraded
+    shape = 2;
+
+  //the edge band is never loot, so blocks past the map need no check
+  if (shape != -1 && (aheadY != 0 || aheadX != 0)) {
+    int found[3] = {0, 0, 0}; //ore, artifacts, dirt
+    for (int i = 0; i < shapeSize[shape]; i++) {
+      int ahead = shapes[shape][i][0];
+      int beside = shapes[shape][i][1];
+      int blockY = y + ahead * aheadY + beside * (aheadX != 0);
+      int blockX = x + ahead * aheadX + beside * (aheadY != 0);
+      int loot = LOOT[grid[blockY][blockX]];
+
+      if (loot != -1) {
+        SetBlock(blockY, blockX, MINED);
+        found[loot]++;
+      }
+    }
+    if (found[0] > 0) //the player map is slow enough to only touch when needed
+      player["ore"] += found[0];
+    if (found[1] > 0)
+      player["artifacts"] += found[1];
+    if (found[2] > 0)
+      player["dirt"] += found[2];
+  }
+
+  if (grid[y][x] == DIRT) { //process original block
+
+    int z = Rand() % 100;
+    if (z == 0) { //1% chance artifact in dirt
+      Emit(ARTIFACT_EVENT, 1);
+      player["artifacts"]++;
+    } 
+    else if (z == 1) { //1% chance ore in dirt
+      Emit(ORE_EVENT, 1);
+      player["ore"]++;
+    }
+    player["dirt"]++;
+  } 
+
+  else if (grid[y][x] == SHOP) {
+    StartScene(SHOP_SCENE, y, x);
+  } 
+
+  else if (grid[y][x] == ARTIFACT) {
+    Emit(ARTIFACT_EVENT, 1);
+    player["artifacts"]++;
+  }
+
+  else if (grid[y][x] == ORE) {
+    Emit(ORE_EVENT, 1);
+    player["ore"]++;
+  } 
+
+  //the player only steps in once the fight is won
+  else if (grid[y][x] == MINER) {
+    StartScene(FIGHT_SCENE, y, x);
+    return false;
+  }
+
+  else if (grid[y][x] == MINIBOSS) {
+    StartScene(MINIBOSS_SCENE, y, x);
+    return false;
+  }
+
+  else if (grid[y][x] == BOSS) {
+    StartScene(BOSS_SCENE, y, x);
+    return false;
+  }
+
+  else if (grid[y][x] == EDGE) //the end of the mines
+    return false;
+
+  return true;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//calls shop when player steps into a shop, one answer at a time
+//parameter: players answer to the last question
+void Game::CallShop(const std::string &answer) {
+  char x = answer[0];
+
+  switch (scene.step) {
+    case 0: //walking in
+      sceneOut << "You come across a small opening and see that there's a store inside.\n";
+      sceneOut << "Would you like to shop? I buy Ore! Enter Y if yes!\n";
+      Ask(1);
+      return;
+
+    case 1: //first chance to shop
+      if (!(x == 'y' || x == 'Y')) {
+        sceneOut << "This could be goodbye forever. Enter Y if you want to shop.\n";
+        Ask(2);
+        return;
+      }
+      break;
+
+    case 2: //last chance to shop
+      if (!(x == 'y' || x == 'Y')) {
+        LeaveShop();
+        return;
+      }
+      break;
+
+    case 3: //picked from the sign
+      if (x == '1') {
+        sceneOut << "How much?\n";
+        Ask(4);
+        return;
+      }
+      else if (x == '2') {
+        sceneOut << "How much?\n";
+        Ask(5);
+        return;
+      }
+      else if (x == '3') {
+        if (!scene.asked) { //can only see upgrade offer once
+          scene.asked = true;
+          if (Trade()) {
+            Ask(6);
+            return;
+          }
+        } else {
+          sceneOut << "We've already discussed that. I'm not sayin it all again.\n\n";
+          Pause(3);
+        }
+      }
+      else if (x == '4' || x == 'q') {
+        LeaveShop();
+        return;
+      }
+      else { //invalid input
+        sceneOut << "Sorry, I didn't get that. Which number did you want?\n\n";
+        Pause(3);
+      }
+      break;
+
+    case 4:
+      SellOre(atoi(answer.c_str()));
+      break;
+
+    case 5:
+      BuyArtifacts(atoi(answer.c_str()));
+      break;
+
+    case 6:
+      TakeTrade(x);
+      break;
+  } //end switch
+
+  //back to the sign
+  sceneOut << "\n\nYou take inventory: Ore: " << player["ore"] << "  Artifacts: ";
+  sceneOut << player["artifacts"] << "  Coins " << player["coins"] << '\n';
+
+  Shop &shop = ShopAt(scene.y, scene.x);
+  sceneOut << "The shop owner poins to a sign that reads:\n\nPick:\n";
+  sceneOut << "1. Sell ore (" << OrePrice(shop) << "/pc!)\n";
+  sceneOut << "2. Buy artifacts (" << ARTIFACT_PRICE << "/pc, " << (int)shop.stock << " left)\n";
+  sceneOut << "3. Deal of the Day\n4. Leave\n\nWhat would you like to do?\n";
+  Ask(3);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//shop helper when the player walks out, they get some bread on the way
+void Game::LeaveShop() {
+  sceneOut << "\nAlright, see you later. Oh, and grab some bread on your way out. Keeps ya hardy.\n";
+  Pause(3);
+
+  player["health"] = player["maxHP"]; //heals player
+  sceneOut << "The bread looks delicious. You grab some and take a bite. On your way out you feel";
+  sceneOut << " refreshed. Ahh, bread.\n";
+
+  Pause(4);
+  EndScene();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//initializes globals and calls GenMap
+//parameters: seed for this games random numbers, blocks per side of the map
+void Game::Init(unsigned int seed, int size) {
+  rng.seed(seed);
+  mapSeed = seed;
+  SetSize(size);
+
+  //set globals
+  player["x"] = player["y"] = gridUpper/2;//player starting in middle of the map
+  player["damage"] = 10;
+  player["ore"] = player["artifacts"] = player["dirt"] = player["coins"] = 0;
+  player["kills"] = player["died"] = player["level"] = 0;
+  player["health"] = player["maxHP"] = 35;
+  player["markY"] = player["markX"] = player["marked"] = player["sight"] = 0; //no turn adds a key
+
+  game = true;
+  for (int i = 0; i < UPGRADE_UPPER; i++) {
+    upgrades[i] = 0;
+  }
+  scene = Scene(); //nothing playing yet
+
+  //make and set map
+  grid.Assign(gridUpper, DIRT, EDGE);
+  MinerList.clear();
+  MinerList.reserve(minerCount); //room for every miner there can be, respawns never grow it
+  wheel.Clear(0, minerCount + WHEEL_SLOTS);
+  GenerateGrid();
+  ClearShops(); //no one has traded anywhere yet
+
+  //a miner that would have started on the player is made up for later
+  for (int i = MinerList.size(); i < minerCount; i++)
+    QueueRespawn();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//sizes the map and everything that scales with it, the grid itself is left
+//for the caller to fill
+//parameter: blocks per side, at least one cluster wide
+void Game::SetSize(int size) {
+  if (size < CLUSTER)
+    size = CLUSTER;
+
+  gridUpper = size;
+  minerCount = size * MINERS_PER_SIDE;
+  tileSide = (size + TILE - 1) / TILE;
+  bucketSide = (size + BUCKET - 1) / BUCKET;
+  clusterSide = (size + CLUSTER - 1) / CLUSTER;
+  regionSide = (size + FLOW_REGION - 1) / FLOW_REGION;
+  exploredWords = (size + 63) / 64;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//plays out the players action, anything worth showing is left in events
+//parameters: action from the front end, 0-3 move, 4 hold, 8 travel to the
+//nearest shop, 9 mark the spot, 10 travel back to the mark, and how many
+//steps a move should take
+//returns true if the miners should take their turn afterwards
+bool Game::Act(int action, int steps) {
+  int shopY, shopX;
+  ClearScratch();
+
+  switch (action) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+      if (steps > 1)
+        return Run(action, steps); //miners moved with every step but a scene's
+      Move(action);
+      return true;
+
+    case 4: //hold your ground
+      return true;
+
+    case 8: //travel to the nearest shop
+      if (NearestLandmark(0, player["y"], player["x"], shopY, shopX) != -1)
+        return Travel(shopY, shopX); //miners move with every step
+      return false;
+
+    case 9: //mark this spot
+      player["markY"] = player["y"];
+      player["markX"] = player["x"];
+      player["marked"] = 1;
+      Emit(MARK_EVENT, 0);
+      return false;
+
+    case 10: //travel back to the mark
+      if (player["marked"] == 1)
+        return Travel(player["markY"], player["markX"]);
+      Emit(NO_MARK_EVENT, 0);
+      return false;
+  }
+  return false;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//finishes a turn once its scene is over, the miners move and a fallen
+//player gets their one revive
+//parameter: true if the miners take their turn
+void Game::EndTurn(bool update) {
+  ClearScratch();
+  if (update)
+    MoveMiners();
+
+  if (player["died"] == 1)
+    StartScene(REVIVE_SCENE, player["y"], player["x"]);
+
+  if (player["health"] <= 0)
+    game = false;
+
+  SetBlock(player["y"], player["x"], PLAYER);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns a random number from 0 up, like rand() but only for this game
+int Game::Rand() {
+  return (int)(rng() >> 1);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//totals the final score of the game
+int Game::Score() {
+  int score = -120; //accounts for initial values player starts with
+
+  for (int i = 0; i < UPGRADE_UPPER; i++) {
+    if (upgrades[i] > 0)
+      score += upgrades[i]*100;
+  }
+
+  score += player["dirt"];
+  score += player["ore"]*5;
+  score += player["artifacts"]*30;
+  score += player["coins"]*3;
+  score += player["damage"]*5;
+  score += player["maxHP"]*2;
+  score += player["kills"]*50;
+  return score;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//counts the memory held by each part of the game. tree and hash nodes are
+//estimated from what the standard library keeps in them, the rest is exact
+//parameter: filled with one entry per part
+void Game::MemoryUse(std::vector<MemoryPart> &parts) {
+  std::ostringstream note;
+  MemoryPart part;
+  long long bytes;
+
+  part.name = "Grid";
+  part.bytes = grid.Bytes();
+  const char *pageNames[4] = {"heap", "mapped", "huge pages", "reserved huge pages"};
+  note << gridUpper << "x" << gridUpper << " blocks plus edge and padding, " << pageNames[grid.pages];
+  part.note = note.str();
+  parts.push_back(part);
+
+  note.str("");
+  note << MinerList.size() << " alive of " << minerCount << " at most, room for " << MinerList.capacity();
+  part.name = "Miners";
+  part.bytes = MinerList.capacity() * sizeof(Rogue);
+  part.note = note.str();
+  parts.push_back(part);
+
+  note.str("");
+  note << shops.count << " traded with, room for " << shops.places.size() * 3 / 4;
+  part.name = "Shops";
+  part.bytes = shops.Bytes();
+  part.note = note.str();
+  parts.push_back(part);
+
+  note.str("");
+  note << wheel.set << " set on turn " << wheel.now << ", room for " << wheel.timers.capacity();
+  part.name = "Timers";
+  part.bytes = wheel.timers.capacity() * sizeof(Timer);
+  part.note = note.str();
+  parts.push_back(part);
+
+  //a tree node is the pair and three links and a color
+  bytes = 0;
+  for (std::map<std::string, int>::iterator it = player.begin(); it != player.end(); it++)
+    bytes += sizeof(*it) + 4 * sizeof(void*) + (it->first.capacity() > 15 ? it->first.capacity() + 1 : 0);
+  note.str("");
+  note << player.size() << " keys";
+  part.name = "Player";
+  part.bytes = bytes;
+  part.note = note.str();
+  parts.push_back(part);
+
+  bytes = 0;
+  for (int i = 0; i < RESOURCES; i++)
+    bytes += density[i].capacity() * sizeof(int);
+  part.name = "Density index";
+  part.bytes = bytes;
+  part.note = "fenwick trees of ore, artifacts and miners";
+  parts.push_back(part);
+
+  bytes = 0;
+  long long marks = 0;
+  for (int i = 0; i < LANDMARKS; i++) {
+    bytes += landmarks[i].capacity() * sizeof(std::vector<int>);
+    for (long long unsigned int j = 0; j < landmarks[i].size(); j++) {
+      bytes += landmarks[i][j].capacity() * sizeof(int);
+      marks += landmarks[i][j].size();
+    }
+  }
+  note.str("");
+  note << marks << " shops and monsters";
+  part.name = "Landmark index";
+  part.bytes = bytes;
+  part.note = note.str();
+  parts.push_back(part);
+
+  bytes = 0;
+  for (int i = 0; i < MIP_LEVELS; i++)
+    for (int j = 0; j < MIP_KINDS; j++)
+      bytes += pyramid[i][j].capacity() * sizeof(int);
+  part.name = "Minimap pyramid";
+  part.bytes = bytes;
+  part.note = "block counts for the map at three zooms";
+  parts.push_back(part);
+
+  note.str("");
+  note << exploredCount << " blocks seen";
+  part.name = "Explored";
+  part.bytes = (explored.capacity() + fov.capacity()) * sizeof(unsigned long long);
+  part.note = note.str();
+  parts.push_back(part);
+
+  bytes = clusters.capacity() * sizeof(Cluster);
+  int made = 0;
+  for (long long unsigned int i = 0; i < clusters.size(); i++) {
+    bytes += (clusters[i].nodes.capacity() + clusters[i].sides.capacity() + clusters[i].dist.capacity()) * sizeof(int);
+    if (!clusters[i].dirty)
+      made++;
+  }
+  note.str("");
+  note << made << " of " << clusters.size() << " clusters summarized";
+  part.name = "Travel clusters";
+  part.bytes = bytes;
+  part.note = note.str();
+  parts.push_back(part);
+
+  bytes = flows.capacity() * sizeof(std::vector<unsigned short>);
+  made = 0;
+  for (long long unsigned int i = 0; i < flows.size(); i++) {
+    bytes += flows[i].capacity() * sizeof(unsigned short);
+    if (!flows[i].empty())
+      made++;
+  }
+  note.str("");
+  note << made << " of " << flows.size() << " regions made";
+  part.name = "Shop flow fields";
+  part.bytes = bytes;
+  part.note = note.str();
+  parts.push_back(part);
+
+  //a hash node is the pair and a link, plus a pointer per bucket
+  note.str("");
+  note << odds.size() << " fight states";
+  part.name = "Miniboss odds";
+  part.bytes = odds.size() * (sizeof(std::pair<const long long, Odds>) + sizeof(void*)) +
+               odds.bucket_count() * sizeof(void*);
+  part.note = note.str();
+  parts.push_back(part);
+
+  note.str("");
+  note << "most a turn used " << scratch.most << " bytes, over " << scratch.resets << " turns and scene steps";
+  part.name = "Turn scratch";
+  part.bytes = scratch.block.capacity() + scratch.spilled;
+  part.note = note.str();
+  parts.push_back(part);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//leaves an event for the front end to show
+//parameters: event type and the amount that goes with it
+void Game::Emit(int type, int value) {
+  Event event;
+  event.type = type;
+  event.value = value;
+  event.seconds = 0;
+  events.push_back(std::move(event));
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//takes back this turns scratch memory, if everything in it has been shown.
+//called as each turn and each answered scene step starts, never in the
+//middle of one, so nothing in the scratch can still be in use
+void Game::ClearScratch() {
+  if (!events.empty() || !sceneText.empty())
+    return;
+
+  //the event list and scene text let go of the block before it is reused
+  std::pmr::vector<Event>(&scratch).swap(events);
+  std::pmr::string(&scratch).swap(sceneText);
+  scratch.Reset();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//shop helper if you want to sell ore
+//parameter: how much ore the player asked to sell
+void Game::SellOre(int amount) {
+  if (amount > player["ore"]) {
+    sceneOut << "You don't have enough ore! You only have " << player["ore"] << " ore\n\n";
+    Pause(2);
+  } 
+  else if (amount == 0) {
+    sceneOut << "Alright...\n";
+    Pause(2);
+  }
+  else {
+    player["ore"] -= amount;
+    player["coins"] += SellToShop(ShopAt(scene.y, scene.x), amount);
+    sceneOut << "Pleasure doing business with you!\n\n";
+    Pause(2);
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//shop helper if you want to buy artifacts
+//parameter: how many artifacts the player asked to buy
+void Game::BuyArtifacts(int amount) {
+  Shop &shop = ShopAt(scene.y, scene.x);
+
+  if (amount*ARTIFACT_PRICE > player["coins"]) {
+    sceneOut << "You don't have enough coins! You only have " << player["coins"] << " coins\n\n";
+    Pause(2);
+    return;
+  } 
+  else if (amount > shop.stock) {
+    sceneOut << "I don't have that many! I've only got " << (int)shop.stock << " left\n\n";
+    Pause(2);
+  }
+  else if (amount == 0) {
+    sceneOut << "Umm... Okay.\n";
+    Pause(2);
+  } else {
+    player["coins"] -= amount*ARTIFACT_PRICE;
+    player["artifacts"] += amount;
+    shop.stock -= amount;
+    QueueRestock(shop);
+    sceneOut << "Pleasure doing business with you!\n\n";
+    Pause(2);
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//shop helper if you want to trade for an upgrade, makes the shops one offer
+//returns true if there is something on offer to answer to
+bool Game::Trade() {
+  Shop &shop = ShopAt(scene.y, scene.x);
+  int cost = shop.cost;
+  int random = shop.offer; //the upgrade the shop has
+
+  if (random == NO_OFFER) {
+    sceneOut << "\nI already sold you my one fine deal. Nothing special left, sorry!\n";
+    Pause(3);
+    return false;
+  }
+
+  sceneOut << "\nOkay, I only have one fine deal for you.\n";
+  sceneOut << "If you have " << cost << " ancient artifacts then I may consider selling...\n";
+  sceneOut << "The only item that would help you is a magnificent Upgrade!\n\n";
+
+  if (upgrades[random] >= UPGRADE_TOP) { //3 is the max level an upgrade can achieve
+    sceneOut << "Oh... It looks like you already have the upgrade I was going to offer.\n";
+    sceneOut << "Looks like I have nothing special, sorry!\n";
+    Pause(4);
+    return false;
+  } 
+
+  switch(random) {
+    case 0:
+      sceneOut << "This book enchants the sword of the user for extra damage.\n";
+      break;
+    case 1:
+      sceneOut << "This ring gives your eyes the ability to see much farther.\n";
+      break;
+    case 2:
+      sceneOut << "This enhancement will allow you to swing wider.\n";
+      break;
+    case 3:
+      sceneOut << "This enhancement will allow you to dig deeper.\n";
+      break;
+    case 4:
+      sceneOut << "Ever see some glints of ore in the mines? Carrying around ";
+      sceneOut << "this trinket will guide your eyes to the valuables.\n";
+      break;
+    case 5:
+      sceneOut << "This potion will make you much hardier. Trust me, looks like you need it.\n";
+      break;
+    case 6:
+      sceneOut << "This compass leads to a deep, dark, secret. I do not know where it\n";
+      sceneOut << "goes nor do I wish to. This is a cursed object... Beware.\n";
+      break;
+  } //end switch
+
+  sceneOut << "Do you want to buy it for " << cost << " artifacts? Enter Y if yes.\n";
+  scene.cost = cost;
+  scene.offer = random;
+  return true;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//shop helper for the players answer to the upgrade offer
+//parameter: players answer, Y to buy
+void Game::TakeTrade(char input) {
+  if (input == 'y' || input == 'Y') {
+    if (player["artifacts"] >= scene.cost) {
+      player["artifacts"] -= scene.cost;
+      Upgrade(scene.offer);
+      ShopAt(scene.y, scene.x).offer = NO_OFFER; //the shop only had the one
+      sceneOut << "Pleasure doing business with you!\n\n";
+      Pause(2);
+
+    } else {
+      sceneOut << "Looks like you don't have enough artifacts for me. Figures...\n\n";
+      Pause(2);
+    }
+  } else {
+    sceneOut << "Right... You're missing out buddy.\n\n";
+    Pause(2);
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+/* UPGRADE LIST
+upgrades[0] = increases sword dmg
+upgrades[1] = increases sight
+upgrades[2] = increases mining depth //unimplemented
+upgrades[3] = increases mining width //unimplemented
+upgrades[4] = increases 'clarity', allowing for better sight on ore/artifacts
+upgrades[5] = increases health
+upgrades[6] = leads player to final boss
+*/
+
+//processes which upgrade to give player
+void Game::Upgrade(int x) {
+  switch (x) {
+    case 0:
+      upgrades[0] += 1; //sword dmg
+      player["damage"] += 5;
+      break;
+    case 1:
+      upgrades[1] += 1; //sight
+      player["sight"] += 1;
+      break;
+    case 2:
+      upgrades[2] += 3; //mining width
+      break;
+    case 3:
+      upgrades[3] += 3; //mining depth
+      break;
+    case 4:
+      upgrades[4]++;
+      break;
+    case 5:
+      upgrades[5]++;
+      player["health"] += 15;
+      player["maxHP"] += 15;
+      break;
+    case 6:
+      upgrades[6] += 3;
+      break;
+  } //end switch
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//forgets every shop, with room for all the shops on the map so the table
+//never has to grow in the middle of a turn
+void Game::ClearShops() {
+  int count = 0;
+  for (long long unsigned int i = 0; i < landmarks[0].size(); i++)
+    count += landmarks[0][i].size();
+  shops.Clear(count);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//finds what a shop remembers, setting it up the first time anyone trades
+//there: fully stocked, and with the one upgrade it will ever offer
+//parameters: YX co-ord. of the shop
+//returns the shop, only good until the next shop is set up
+Shop &Game::ShopAt(int y, int x) {
+  int key = y * gridUpper + x;
+  Shop *found = shops.Find(key);
+  if (found != NULL)
+    return *found;
+
+  Shop &shop = shops.Add(key);
+  shop.ore = 0;
+  shop.stock = SHOP_STOCK;
+  shop.restocking = false;
+
+  //cost ranges from 15-35
+  //nums 16-29 have a higher probability
+  int cost = Rand() % 35;
+  if (cost < 15) { cost += 15; }
+
+  shop.offer = Rand() % UPGRADE_UPPER; //picks what upgrade the shop has
+  if (shop.offer == 2 || shop.offer == 3)
+    cost += 10; //upgrade costs more due to power
+  shop.cost = cost;
+  return shop;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//what a shop pays for a piece of ore, less the more it is sitting on
+//parameter: the shop
+//returns coins, at least 1
+int Game::OrePrice(const Shop &shop) {
+  int price = ORE_PRICE - shop.ore / ORE_GLUT;
+  return price < 1 ? 1 : price;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//sells ore to a shop a piece at a time, each piece it takes can lower the
+//price of the next
+//parameters: the shop and how much ore
+//returns coins paid
+int Game::SellToShop(Shop &shop, int amount) {
+  int coins = 0;
+
+  for (int i = 0; i < amount; i++) {
+    coins += OrePrice(shop);
+    shop.ore++;
+  }
+  QueueRestock(shop);
+  return coins;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//sets a shops restock timer if it doesnt have one going already
+//parameter: the shop
+void Game::QueueRestock(Shop &shop) {
+  if (shop.restocking)
+    return;
+  shop.restocking = true;
+  wheel.Set(wheel.now + RESTOCK_TURNS, RESTOCK_TIMER, shop.key);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//ships some of a shops ore off and brings in an artifact, again every
+//RESTOCK_TURNS until it is back to how it started
+//parameter: packed YX of the shop
+void Game::RestockShop(int key) {
+  Shop *shop = shops.Find(key);
+  if (shop == NULL)
+    return;
+
+  shop->ore = shop->ore > ORE_GLUT ? shop->ore - ORE_GLUT : 0;
+  if (shop->stock < SHOP_STOCK)
+    shop->stock++;
+
+  shop->restocking = false;
+  if (shop->ore > 0 || shop->stock < SHOP_STOCK)
+    QueueRestock(*shop);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//creates initial values for the enemy miners and sets the timer for their
+//first move, they go on the end of MinerList
+//parameters: miner to be initalized
+void Game::InitMiner(Rogue &miner, int y, int x) {
+  miner.artifacts = 0;
+  miner.coins = 25;
+  miner.damage = 8;
+  miner.ore = 0;
+  miner.health = 30;
+  miner.y = y;
+  miner.x = x;
+  miner.direction = Rand() % 4;
+  miner.pace = MINER_PACE;
+  //half the miners move on the next turn and half the turn after
+  miner.timer = wheel.Set(wheel.now + 1 + (miner.x % 2 == 0), MINER_TIMER, MinerList.size());
+  grid[miner.y][miner.x] = MINER;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//moves the miners due this turn, only the living have timers
+void Game::MoveMiners() {
+  ProfileScope scope(MINERS_PHASE);
+  RunTimers(NULL, 0, 0, 0);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//moves the wheel on a turn and sets off every timer due on it, in the order
+//they were set
+//parameters: moves put off per miner, counting those of miners further than
+//reach from the YX co-ord., NULL to move every miner now
+void Game::RunTimers(std::pmr::vector<int> *owed, int y, int x, int reach) {
+  wheel.Advance();
+
+  for (int timer = wheel.Pop(); timer != -1; timer = wheel.Pop()) {
+    int id = wheel.timers[timer].id;
+
+    switch (wheel.timers[timer].kind) {
+      case MINER_TIMER: {
+        Rogue &miner = MinerList[id];
+        if (owed == NULL || abs(miner.y - y) + abs(miner.x - x) <= reach)
+          MoveMiner(miner);
+        else
+          (*owed)[id]++;
+        wheel.Rearm(timer, wheel.now + miner.pace);
+        break;
+      }
+
+      case RESPAWN_TIMER:
+        wheel.Free(timer);
+        RespawnMiner();
+        break;
+
+      case RESTOCK_TIMER:
+        wheel.Free(timer);
+        RestockShop(id);
+        break;
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//takes a fallen miner out of the list. the last miner moves into its slot so
+//the list stays packed, and the slot freed at the end is what respawns reuse
+//parameter: index of the miner in MinerList
+void Game::RemoveMiner(int index) {
+  wheel.Cancel(MinerList[index].timer);
+  MinerList[index] = MinerList.back();
+  MinerList.pop_back();
+  if (index < (int)MinerList.size())
+    wheel.timers[MinerList[index].timer].id = index; //its timer follows it
+
+  QueueRespawn();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//sets a timer for a new miner to come in, somewhere from 1 to twice
+//RESPAWN_TURNS turns from now
+void Game::QueueRespawn() {
+  wheel.Set(wheel.now + 1 + Rand() % (2 * RESPAWN_TURNS), RESPAWN_TIMER, 0);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//brings a new miner into the mines to make up for one fallen, somewhere out
+//of earshot of the player. it takes a slot a fallen miner left, so the list
+//never grows past minerCount
+void Game::RespawnMiner() {
+  if ((int)MinerList.size() >= minerCount)
+    return;
+
+  int y = Rand() % gridUpper;
+  int x = Rand() % gridUpper;
+  if ((grid[y][x] != DIRT && grid[y][x] != MINED) ||
+      (abs(y - player["y"]) <= PROSPECT_RANGE && abs(x - player["x"]) <= PROSPECT_RANGE)) {
+    wheel.Set(wheel.now + 1, RESPAWN_TIMER, 0); //tries again next turn
+    return;
+  }
+
+  Rogue miner;
+  SetBlock(y, x, MINER);
+  InitMiner(miner, y, x);
+  MinerList.push_back(miner);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//moves a miner on the map
+//parameter: miner to be moved
+void Game::MoveMiner(Rogue &miner) {
+  //miners with something to sell head for the nearest shop
+  int seek = -1;
+  if (miner.ore > 0 || miner.artifacts >= 10)
+    seek = FlowDirection(miner);
+
+  int change = Rand() % 10;
+  if (seek != -1)
+    miner.direction = seek;
+  else if (change == 0)
+    miner.direction = Rand() % 4;
+
+  //the edge band blocks miners like rock they cant dig, so no bounds check
+  const int stepY[4] = {-1, 0, 1, 0};
+  const int stepX[4] = {0, -1, 0, 1};
+  int y = miner.y + stepY[miner.direction];
+  int x = miner.x + stepX[miner.direction];
+
+  if (ProcessBlock(miner, y, x)) {
+    SetBlock(y, x, MINER);
+    if (grid[miner.y][miner.x] != PLAYER)
+      SetBlock(miner.y, miner.x, MINED);
+    else
+      SetBlock(miner.y, miner.x, PLAYER);
+    miner.y = y;
+    miner.x = x;
+  } else {
+    SetBlock(miner.y, miner.x, MINER);
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns true if valid move, false if invalid
+//special interaction on Shop blocks
+//parameters: miner to be moved and the YX co-ord. of where they want to go
+bool Game::ProcessBlock(Rogue &miner, int y, int x) {
+  switch (grid[y][x]) {
+    case ORE: //adds ore to sell at shops
+      miner.ore++;
+      break;
+
+    case SHOP: //makes miner more valuable to fight over time
+      //sells all ore and adds to miner coins, the shop pays less the more it gets
+      if (miner.ore > 0) {
+        miner.coins += SellToShop(ShopAt(y, x), miner.ore);
+        miner.ore = 0;
+      }
+      //upgrades miner if they have enough artifacts
+      if (miner.artifacts >= 10) {
+        miner.artifacts -= 10;
+        miner.damage += 5;
+      }
+      //changes miner direction so they leave the shop and dont idle
+      miner.direction = Rand() % 4;
+      return false;
+
+    case ARTIFACT: //adds artifacts to upgrade dmg at shops
+      miner.artifacts++;
+      break;
+
+    case PLAYER: //damages player if theyre in the way
+      Emit(HIT_EVENT, miner.damage/2);
+      player["health"] -= miner.damage/2;
+
+      //player death
+      if (player["health"] <= 0) {
+        game = false;
+        player["died"]++;
+        player["health"] = 0;
+        Emit(SLAIN_EVENT, 0);
+      }
+      return false;
+
+    case MINER: //doesn't allow overlap
+    case MINIBOSS:
+    case BOSS:
+      miner.direction = Rand() % 4;
+      return false;
+
+    case EDGE: //waits at the end of the mines like it always has
+      return false;
+  }
+  return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+
+//processes player fighting with enemy miner, one answer at a time
+//parameter: players answer to the last question
+void Game::MinerFight(const std::string &answer) {
+  if (scene.step == 0) {
+    sceneOut << "You have come across another miner. They are competition.\n";
+    sceneOut << "Do you swing? Enter Y for yes.\n";
+    Ask(1);
+    return;
+  }
+
+  char in = answer[0];
+
+  if (!(in == 'Y' || in == 'y')) { //player doesnt want to fight
+    sceneOut << "He raises his pick to swing at you but doesn't. You brush past each other.\n";
+    Pause(3);
+    EndScene();
+    return;
+  }
+
+  //player fights
+  int enemyIndex = -1; //index of miner in MinerList to fight
+  int deviation = Rand() % 5; //random chance to change the dmg
+  int damage; 
+
+  //computes index
+  for (long long unsigned int i = 0; i < MinerList.size(); i++) {
+    if (MinerList[i].y == scene.y && MinerList[i].x == scene.x) {
+      enemyIndex = i;
+      break;
+    }
+  }
+
+  //a miner mark with no miner behind it, just clears the block
+  if (enemyIndex == -1) {
+    sceneOut << "You swing at the shadow but there is nobody there.\n";
+    Pause(2);
+    SetBlock(scene.y, scene.x, MINED);
+    EndScene();
+    return;
+  }
+
+  //computes damage
+  if (deviation == 0) //no change on dmg
+    damage = player["damage"];
+  else if (deviation == 1 || deviation == 2) //negative 1 or 2 from base dmg
+    damage = player["damage"] - deviation;
+  else //positive 1 or 2 from base dmg
+    damage = player["damage"] + (deviation-2);
+
+  //effects
+  sceneOut << "You approach the miner and swing with all your might.\n";
+  sceneOut << "You dealt " << damage << " damage to the miner.\n";
+  Pause(3);
+  MinerList[enemyIndex].health -= damage;
+
+  if (MinerList[enemyIndex].health <= 0) { //if miner dies
+    sceneOut << "AAAGH... the miner lets out a last scream before falling down.\n";
+    sceneOut << "They won't be getting back up from that.\n";
+    Pause(3);
+
+    player["kills"]++;
+    sceneOut << "You gain " << MinerList[enemyIndex].coins << " coins.\n";
+    player["coins"] += MinerList[enemyIndex].coins;
+    RemoveMiner(enemyIndex);
+    Pause(3);
+
+    if (player["kills"] % 5 == 0) {
+      sceneOut << "Your bloodlust unlocks new potential inside of you.\n";
+      sceneOut << "The experience gained from killing has made you stronger and faster\n";
+      Pause(5);
+      player["health"] += 5;
+      player["maxHP"] += 5;
+      player["level"]++;
+    }
+    EnterBlock(scene.y, scene.x);
+  } 
+  else { //miner lives and retaliates
+    damage = Rand() % 4;
+    damage += 6;
+
+    sceneOut << "The miner swings their pick back and dealt " << damage;
+    sceneOut << " damage!\n";
+    Pause(3);
+
+    player["health"] -= damage;
+    if (player["health"] <= 0) {
+      game = false;
+      player["died"]++;
+
+      sceneOut << "The pick impales you and leaves you with a gash too wide to mend.";
+      Pause(2);
+
+      sceneOut << "\nYou fall down on the hard rocks and reflect as you die.\n";
+      Pause(4);
+      player["health"] = 0;
+    }
+  } 
+  EndScene();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//saves the state of the current game
+//parameter: stream to write the save to
+bool Game::SaveGame(std::ostream &MyFile) {
+  ProfileScope scope(SAVE_PHASE);
+  //save grid
+  for (int y = 0; y < gridUpper; y++) {
+    for (int x = 0; x < gridUpper; x++) {
+      MyFile << (char)('0' + grid[y][x]);
+    }
+    MyFile << '\n';
+  }
+
+  //save player
+  MyFile << player["y"] << ',' << player["x"] << ',' << player["damage"];
+  MyFile << ',' << player["ore"] << ',' << player["dirt"];
+  MyFile << ',' << player["artifacts"] << ',' << player["coins"];
+  MyFile << ','<< player["kills"] << ','<< player["health"];
+  MyFile << ',' << player["maxHP"]<< ',' << player["died"];
+  MyFile << ',' << player["bossY"]<< ',' << player["bossX"];
+  MyFile << ',' << player["level"] << '\n';
+
+  //save upgrades
+  for (int i = 0; i < UPGRADE_UPPER; i++) {
+    MyFile << upgrades[i] << ',';
+  }
+  MyFile << '\n';
+
+  //save miners, only the living are in the list
+  for (long long unsigned int i = 0; i < MinerList.size(); i++) {
+    MyFile << MinerList[i].damage << ',' << MinerList[i].coins << ',';
+    MyFile << MinerList[i].artifacts << ',' << MinerList[i].health << ',';
+    MyFile << MinerList[i].y << ',' << MinerList[i].x << ',';
+    MyFile << MinerList[i].direction << ',';
+    MyFile << wheel.timers[MinerList[i].timer].due - wheel.now - 1 << ','; //turns till it moves
+    MyFile << MinerList[i].ore << ',' << MinerList[i].pace << '\n';
+  }
+
+  //save what the player has seen and the shops they and the miners traded with
+  SaveExplored(MyFile);
+  SaveShops(MyFile);
+
+  return MyFile.good();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//loads a saved game into the current game. the save is read and checked
+//first and the game only changes once all of it is good, so a bad save
+//leaves the game as it was
+//parameter: stream to read the save from
+//returns false if the save couldnt be read
+bool Game::LoadGame(std::istream &MyFile) {
+  ProfileScope scope(LOAD_PHASE);
+  SaveData save;
+
+  save.player = player; //anything the save doesnt have stays as it is
+  if (!ReadSave(MyFile, save))
+    return false;
+
+  SetSize(save.grid.size);
+  grid.Swap(save.grid);
+  player.swap(save.player);
+  std::copy(save.upgrades, save.upgrades + UPGRADE_UPPER, upgrades);
+
+  //the miners pick up their timers where the save left them
+  MinerList.clear();
+  MinerList.reserve(minerCount);
+  wheel.Clear(0, minerCount + WHEEL_SLOTS);
+  for (long long unsigned int i = 0; i < save.miners.size(); i++) {
+    save.miners[i].timer = wheel.Set(wheel.now + 1 + save.waits[i], MINER_TIMER, MinerList.size());
+    MinerList.push_back(save.miners[i]);
+  }
+  for (int i = MinerList.size(); i < minerCount; i++)
+    QueueRespawn();
+
+  LoadExplored(save.explored);
+
+  //load game
+  game = true;
+  BuildIndexes();
+  LoadShops(save.shops); //needs the landmarks
+  return true;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//reads a whole save without touching the game, checking every block,
+//position and level that indexes something
+//parameters: stream to read the save from, where it is read into
+//returns false if the save is cut short or has a bad value in it
+static bool ReadSave(std::istream &MyFile, SaveData &save) {
+  std::string line;
+  std::string item;
+  std::string delimiter = ",";
+  size_t position = 0;
+  int temp;
+  int num;
+
+  //the first row of the grid says how big the map is
+  std::getline(MyFile, line);
+  if (!line.empty() && line[line.size()-1] == '\r')
+    line.erase(line.size()-1);
+  if ((int)line.size() < CLUSTER)
+    return false;
+
+  int size = line.size();
+  save.grid.Assign(size, DIRT, EDGE);
+  for (int x = 0; x < size; x++) {
+    if (line[x] < '0' || line[x] >= '0' + EDGE)
+      return false; //blocks index tables, a bad one would read past them
+    save.grid[0][x] = line[x] - '0';
+  }
+
+  //load grid
+  for (int y = 1; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      temp = MyFile.get();
+      if (temp < '0' || temp >= '0' + EDGE)
+        return false; //cut short or not a block
+      save.grid[y][x] = temp - '0';
+    }
+    temp = MyFile.get();
+    if (temp == '\r')
+      temp = MyFile.get();
+  }
+  if (!MyFile)
+    return false;
+
+  //load player
+  std::getline(MyFile, line);
+    
+  for (int j = 0; j < 14; j++) {
+    num = 0;
+    position = line.find(delimiter);
+    item = line.substr(0, position);
+
+    for (int i = 0; item[i] != '\0'; i++) {
+      num = num * 10 + item[i] - '0';
+    }
+
+    switch (j) {
+      case 0:
+        save.player["y"] = num;
+        break;
+      case 1:
+        save.player["x"] = num;
+        break;
+      case 2:
+        save.player["damage"] = num;
+        break;
+      case 3:
+        save.player["ore"] = num;
+        break;
+      case 4:
+        save.player["dirt"] = num;
+        break;
+      case 5:
+        save.player["artifacts"] = num;
+        break;
+      case 6:
+        save.player["coins"] = num;
+        break;
+      case 7:
+        save.player["kills"] = num;
+        break;
+      case 8:
+        save.player["health"] = num;
+        break;
+      case 9:
+        save.player["maxHP"] = num;
+        break;
+      case 10:
+        save.player["died"] = num;
+        break;
+      case 11:
+        save.player["bossY"] = num;
+        break;
+      case 12:
+        save.player["bossX"] = num;
+        break;
+      case 13:
+        save.player["level"] = num;
+    }
+  line.erase(0, position + delimiter.length());
+  }
+
+  //load upgrades
+  std::getline(MyFile, line);
+  for (int i = 0; i < UPGRADE_UPPER; i++) {
+    num = 0;
+    position = line.find(delimiter);
+    item = line.substr(0, position);
+    for (int z = 0; item[z] != '\0'; z++) {
+      num = num * 10 + item[z] - '0';
+    }
+    if (num < 0 || num > UPGRADE_TOP)
+      return false; //sight past the edge band would read off the map
+    save.upgrades[i] = num;
+    line.erase(0, position + delimiter.length());
+  }
+  if (!MyFile || save.player["y"] < 0 || save.player["y"] >= size ||
+      save.player["x"] < 0 || save.player["x"] >= size)
+    return false;
+
+  //load miners, saves only have the living but older ones have the fallen too
+  //and always have minerCount of them
+  int minerCount = size * MINERS_PER_SIDE;
+  line.clear();
+  for (int i = 0; i < minerCount && std::getline(MyFile, line); i++) {
+    if (line.compare(0, 8, "explored") == 0)
+      break; //no more miners
+
+    Rogue miner = Rogue(); //older saves dont have ore or pace
+    miner.pace = MINER_PACE;
+    int wait = 0;
+    int fields = std::count(line.begin(), line.end(), ',') + 1;
+
+    for (int j = 0; j < fields && j < 10; j++) {
+      num = 0;
+      position = line.find(delimiter);
+      item = line.substr(0, position);
+
+      for (int z = 0; item[z] != '\0'; z++) {
+        num = num * 10 + item[z] - '0';
+      }
+
+      switch (j) {
+        case 0:
+          miner.damage = num;
+          break;
+        case 1:
+          miner.coins = num;
+          break;
+        case 2:
+          miner.artifacts = num;
+          break;
+        case 3:
+          miner.health = num;
+          break;
+        case 4:
+          miner.y = num;
+          break;
+        case 5:
+          miner.x = num;
+          break;
+        case 6:
+          miner.direction = num;
+          break;
+        case 7:
+          wait = num;
+          break;
+        case 8:
+          miner.ore = num;
+          break;
+        case 9:
+          miner.pace = num;
+          break;
+      }
+
+      line.erase(0, position + delimiter.length());
+    }
+
+    //older saves say if the miner moves next turn instead of when
+    if (fields < 10)
+      wait = wait ? 0 : 1;
+
+    //the fallen in older saves are off the map, the living cant be. a
+    //direction indexes the steps and a miner has to wait a turn at least
+    if (miner.health > 0) {
+      if (miner.y < 0 || miner.y >= size || miner.x < 0 || miner.x >= size ||
+          miner.direction < 0 || miner.direction > 3 || miner.pace < 1 || wait < 0)
+        return false;
+      save.miners.push_back(miner);
+      save.waits.push_back(wait);
+    }
+    line.clear();
+  }
+  if (!MyFile)
+    return false; //cut short in the miners, saves always end with more
+
+  //what the player has seen, older saves dont have it
+  if (line.compare(0, 8, "explored") != 0 && MyFile.peek() != EOF)
+    std::getline(MyFile, line);
+  save.explored = line;
+
+  //the shops, older saves dont have them
+  line.clear();
+  if (!MyFile.eof() && MyFile.peek() != EOF) //peeking again past the end would fail the stream
+    std::getline(MyFile, line);
+  save.shops = line;
+  return !MyFile.fail();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//how tough the next miniboss is, they grow with the player
+//parameters: set to the monsters health and damage
+void Game::MinibossStats(int &health, int &damage) {
+  health = 65 + upgrades[5] * 5 + player["level"] * 3;
+  damage = 15 + upgrades[0] * 5 + player["level"] * 3;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//works out how a miniboss fight would go right now, exactly, for each of the
+//three answers kept to the whole fight: 1 attack, 2 defend and 3 run
+//parameter: set to the odds of attacking, defending and running
+void Game::MinibossOdds(Odds result[3]) {
+  int health, damage;
+
+  MinibossStats(health, damage);
+  health -= player["damage"]; //the opening swing always lands
+
+  for (int i = 0; i < 3; i++)
+    result[i] = SettleOdds(i, health, player["health"], player["damage"], damage);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//odds of one more round of a miniboss fight, averaged over every roll the
+//round can make. rolls land on -3 to 3 evenly and coin flips on either side,
+//health is cut the way Miniboss cuts it so the odds match the fight exactly
+//parameters: strategy 0 attack 1 defend 2 run, monster health, player health,
+//player damage, monster damage
+//returns the odds from here
+Odds Game::FightOdds(int strategy, int health, int hp, int hit, int damage) {
+  long long key = ((((long long)strategy * 1024 + hit) * 1024 + damage) * 4096 + health) * 65536 + hp;
+  std::unordered_map<long long, Odds>::iterator found = odds.find(key);
+  if (found != odds.end())
+    return found->second;
+
+  Odds result = {0, 0, 0}, next;
+  int  newHealth, newHp;
+  double chance;
+
+  for (int first = -3; first <= 3; first++) {
+    switch (strategy) {
+      case 0: //trade blows
+        for (int second = -3; second <= 3; second++) {
+          chance = 1.0 / 49;
+          newHealth = health - (hit + first);
+          newHp = hp - (damage + second);
+          next = SettleOdds(strategy, newHealth, newHp, hit, damage);
+          result.win += next.win * chance;
+          result.hp += next.hp * chance;
+        }
+        break;
+
+      case 1: //brace for half or three quarters, then swing back
+        for (int brace = 0; brace < 2; brace++)
+          for (int second = -3; second <= 3; second++) {
+            chance = 1.0 / 98;
+            newHp = hp - ((brace == 0 ? damage*0.75 : damage*0.5) + first);
+            newHealth = health - (damage*0.75 + second);
+            next = SettleOdds(strategy, newHealth, newHp, hit, damage);
+            result.win += next.win * chance;
+            result.hp += next.hp * chance;
+          }
+        break;
+
+      case 2: //half the time gets away, the rest takes a swipe
+        chance = 1.0 / 14;
+        result.escape += chance;
+        result.hp += hp * chance;
+
+        newHp = hp - (damage*0.5 + first);
+        next = SettleOdds(strategy, health, newHp, hit, damage);
+        result.escape += next.escape * chance;
+        result.hp += next.hp * chance;
+        break;
+    }
+  }
+
+  odds[key] = result;
+  return result;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//odds once a round is over, the fight ends the same way Miniboss ends it
+//parameters: same as FightOdds
+//returns the odds from here
+Odds Game::SettleOdds(int strategy, int health, int hp, int hit, int damage) {
+  Odds result = {0, 0, 0};
+
+  if (hp <= 0) //dying comes first, even if the monster went down too
+    return result;
+  if (health <= 0) { //winning heals the player up to at least 15
+    result.win = 1;
+    result.hp = hp < 15 ? 15 : hp;
+    return result;
+  }
+  return FightOdds(strategy, health, hp, hit, damage);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//engages miniboss fight, one answer at a time
+//parameter: players answer to the last question
+void Game::Miniboss(const std::string &answer) {
+  int random, deviation;
+  char input = answer[0];
+
+  if (scene.step == 0) {
+    MinibossStats(scene.health, scene.damage);
+
+    sceneOut << "A large cave monster rises up in front of you.\n";
+    sceneOut << "It seems to be encased in crystal, looks like a tough fight!\n";
+    Pause(5);
+    sceneOut << "You quickly take a swing and step back before it has time to ";
+    sceneOut << "stabalize.\n";
+    Pause(3);
+
+    sceneOut << "You deal " << player["damage"] << " damage to the creature.\n";
+    Pause(2);
+    scene.health -= player["damage"];
+  }
+  else {
+    int damage = scene.damage;
+
+    deviation = Rand() % 7;
+    if (deviation == 4 || deviation == 5 || deviation == 6) //negative 1-3 from base dmg
+      deviation -= 7;
+
+    switch (input) {
+      case '1':
+        sceneOut << "You deal " << player["damage"] + deviation << " damage to the creature.\n";
+        scene.health -= player["damage"] + deviation;
+        Pause(2);
+
+        deviation = Rand() % 7;
+        if (deviation == 4 || deviation == 5 || deviation == 6) //negative 1-3 from base dmg
+          deviation -= 7;
+
+        sceneOut << "The monster swings back with its sharp crystal arms and deals ";
+        sceneOut << damage + deviation << " damage to you.\n";
+        player["health"] -= damage + deviation;
+        Pause(3);
+        break;
+
+      case '2':
+        random = Rand() % 2;
+        if (random == 0) {
+          sceneOut << "You brace for impact and take " << damage*0.75 + deviation << " damage.\n";
+          player["health"] -= damage*0.75 + deviation;
+          Pause(3);
+        } 
+        else {
+          sceneOut << "You brace for impact and take " << damage*0.5 + deviation << " damage.\n";
+          player["health"] -= damage*0.5 + deviation;
+          Pause(3);
+        }
+
+        deviation = Rand() % 7;
+        if (deviation == 4 || deviation == 5 || deviation == 6) //negative 1-3 from base dmg
+          deviation -= 7;
+
+        sceneOut << "After the monster swings it takes a brief second to recover.\n";
+        sceneOut << "During this time you take a swing at it for " << damage*0.75 + deviation << " damage.\n";
+        scene.health -= damage*0.75 + deviation;
+        Pause(6);
+        break;
+
+      case '3':
+        random = Rand() % 2;
+        if (random == 0) {
+          sceneOut << "After sprinting faster than you thought you could, you manage to outrun";
+          sceneOut << " the giant crystal monster.\nThat was a close one...\n";
+          Pause(5);
+          EndMiniboss(false);
+          return;
+        } 
+        else {
+          sceneOut << "You run a couple of steps before the monster takes a swipe at you.\n";
+          Pause(3);
+          sceneOut << "It throws you off and deals " << damage*0.5 + deviation << " damage to you.\n";
+          player["health"] -= damage*0.5 + deviation;
+          sceneOut << "Looks like you weren't able to outrun it this time...\n";
+          Pause(5);
+        }
+        break;
+
+      default:
+        sceneOut << "Invalid Input.\n";
+        Pause(2);
+        break;
+    }
+  }
+
+  if (player["health"] <= 0) {
+    game = false;
+    player["died"]++;
+    player["health"] = 0;
+
+    sceneOut << "You are pummeled by the giant crystal mass and can't seem to keep fighting.\n";
+    Pause(3);
+    sceneOut << "You close your eyes and accept fate.\n";
+    Pause(3);
+    EndMiniboss(false);
+    return;
+  }
+  else if (scene.health <= 0) {
+    sceneOut << "Your last swing broke off a chunk of the crystal and the monster kneels.\n";
+    sceneOut << "From the wound a bright light shines out and the cracks begin to spread.\n";
+    Pause(5);
+    sceneOut << "Hooray! You have defeated the monster. You rejoice as it begins to crumple beneath you.\n";
+    sceneOut << "The light from the monster begins shining throughout the room before coalescing and circling you.\n";
+    Pause(5);
+    sceneOut << "The waves of light begin flowing inside of you and you feel the power coursing through you.\n";
+    sceneOut << "You feel that your body can take more and fight harder. Awesome!\n";
+    Pause(4);
+    player["damage"] += 10;
+    player["maxHP"] += 15;
+    if (player["health"] < 15)
+      player["health"] = 15;
+    EndMiniboss(true);
+    return;
+  }
+
+  sceneOut << "\nWhat will you do now?\n";
+  sceneOut << "   1. Attack with your pick\n";
+  sceneOut << "   2. Defend and wait to strike\n";
+  sceneOut << "   3. Try to outrun the monster\n";
+  sceneOut << "\nEnter the number.\n";
+  Ask(1);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//ends the miniboss fight, the player takes its place if they won
+//parameter: true if the monster was beaten
+void Game::EndMiniboss(bool won) {
+  if (scene.final) { //stood in for the boss, the game ends either way
+    game = false;
+    player["died"] = 2;
+
+    sceneOut << "You have reached the end.\nThank you for playing!\n";
+    Pause(3);
+
+    if (player["health"] > 0)
+      EnterBlock(scene.y, scene.x);
+  }
+  else if (won)
+    EnterBlock(scene.y, scene.x);
+
+  EndScene();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//engages boss fight, one answer at a time
+//parameter: players answer to the last question
+void Game::Boss(const std::string &answer) {
+  char input = answer[0];
+
+  if (scene.step == 0) {
+    sceneOut << "Before you appears a sudden and bright cave opening.\n";
+    sceneOut << "You get an overwhelming sense of fear and can hear a faint ";
+    sceneOut << "humming coming from the entrance.\n\n";
+    Pause(3);
+    sceneOut << "You get the feeling that this might be something you won't";
+    sceneOut << " come out of.\nDo you want to continue? Enter Y if yes.\n";
+    Ask(1);
+    return;
+  }
+
+  if (!(input == 'y' || input == 'Y')) {
+    EndScene();
+    return;
+  }
+
+  sceneOut << "You enter and there is a large being made of pure crystal.\n";
+  sceneOut << "It begins to move and its eyes begin to glow red.\n";
+  sceneOut << "You prepare to fight!\n";
+  Pause(3);
+
+  sceneOut << "Unimplemented boss minigame.\n"; //TODO
+  Pause(2);
+
+  //the miniboss fights in its place for now, del later
+  scene.kind = MINIBOSS_SCENE;
+  scene.step = 0;
+  scene.final = true;
+  Miniboss("");
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//player gets one get out of jail free card
+//parameter: unused, reviving asks nothing
+void Game::Revive(const std::string &) {
+  game = true;
+  player["died"] = 2;
+  player["health"] = player["maxHP"];
+
+  sceneOut << "\n\nYou slowly come to conciousness... You can tell you are ";
+  sceneOut << "in a lot of pain.\nYou start to open your eyes...\n\n";
+  Pause(4);
+
+  sceneOut << "You see a bright light and begin to hear a voice.\n";
+  sceneOut << "\"I cannot save you again... please stay safe.\"\n";
+  sceneOut << "With that, the light fades and you get back up again.\n";
+  Pause(4);
+
+  SetBlock(player["y"], player["x"], MINED);
+  player["x"] = gridUpper/2;
+  player["y"] = gridUpper/2;
+  SetBlock(player["y"], player["x"], PLAYER);
+  EndScene();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//changes a block on the map and keeps the indexes in step with it
+//parameters: YX co-ord. of the block and the block type it becomes
+void Game::SetBlock(int y, int x, int block) {
+  if (grid[y][x] == block)
+    return;
+
+  //rock opening up or closing in sight of the player changes what they see
+  if (fovValid && OPAQUE[grid[y][x]] != OPAQUE[block] &&
+      y >= fovY - fovRadius && y <= fovY + fovRadius &&
+      x >= fovX - fovRadius && x <= fovX + fovRadius)
+    fovValid = false;
+
+  //travel summaries around the block are made again when next needed
+  if (TravelCost(grid[y][x]) != TravelCost(block))
+    DirtyClusters(y, x, TravelCost(grid[y][x]) == -1 || TravelCost(block) == -1);
+
+  //so are the shop flow fields if a shop or monster came or went
+  if (grid[y][x] == SHOP || grid[y][x] == MINIBOSS || grid[y][x] == BOSS ||
+      block == SHOP || block == MINIBOSS || block == BOSS)
+    DirtyFlows(y, x);
+
+  UpdateDensity(y, x, grid[y][x], -1);
+  RemoveLandmark(y, x, grid[y][x]);
+  UpdatePyramid(y, x, MipKind(grid[y][x]), -1);
+  if (grid[y][x] == SHOP && IsExplored(y, x))
+    UpdatePyramid(y, x, 3, -1);
+
+  grid[y][x] = block;
+  UpdateDensity(y, x, block, 1);
+  AddLandmark(y, x, block);
+  UpdatePyramid(y, x, MipKind(block), 1);
+  if (block == SHOP && IsExplored(y, x))
+    UpdatePyramid(y, x, 3, 1);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+/* RESOURCE LIST
+density[0] = ore
+density[1] = artifacts
+density[2] = miners
+*/
+
+//returns which density tree counts a block, -1 if it isnt counted
+int Game::ResourceType(int block) {
+  switch (block) {
+    case ORE:
+      return 0;
+    case ARTIFACT:
+      return 1;
+    case MINER:
+      return 2;
+    default:
+      return -1;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//counts every resource on the map into the density trees
+//each tree is a 2d fenwick tree over 8x8 tiles so a change costs
+//O(log^2 tiles) and a rectangle count only reads a handful of nodes
+void Game::BuildDensity() {
+  int y, x, type, parent;
+  const int side = tileSide + 1; //trees are 1-indexed
+
+  for (type = 0; type < RESOURCES; type++)
+    density[type].assign(side * side, 0);
+
+  //plain tile counts first
+  for (y = 0; y < gridUpper; y++) {
+    for (x = 0; x < gridUpper; x++) {
+      type = ResourceType(grid[y][x]);
+      if (type != -1)
+        density[type][(y/TILE + 1) * side + x/TILE + 1]++;
+    }
+  }
+
+  //then each node is added into its parent, along rows and then columns
+  for (type = 0; type < RESOURCES; type++) {
+    std::vector<int> &tree = density[type];
+
+    for (y = 1; y <= tileSide; y++) {
+      for (x = 1; x <= tileSide; x++) {
+        parent = x + (x & -x);
+        if (parent <= tileSide)
+          tree[y * side + parent] += tree[y * side + x];
+      }
+    }
+
+    for (y = 1; y <= tileSide; y++) {
+      parent = y + (y & -y);
+      if (parent <= tileSide) {
+        for (x = 1; x <= tileSide; x++)
+          tree[parent * side + x] += tree[y * side + x];
+      }
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//adds to the count of a block type at a position, ignores uncounted blocks
+//parameters: YX co-ord., the block type and how much to add
+void Game::UpdateDensity(int y, int x, int block, int amount) {
+  int type = ResourceType(block);
+  if (type == -1 || density[type].empty())
+    return;
+
+  for (int i = y/TILE + 1; i <= tileSide; i += i & -i) {
+    for (int j = x/TILE + 1; j <= tileSide; j += j & -j)
+      density[type][i * (tileSide+1) + j] += amount;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//sums the first tileY x tileX tiles of one density tree
+int Game::DensityPrefix(int type, int tileY, int tileX) {
+  int sum = 0;
+  for (int i = tileY; i > 0; i -= i & -i) {
+    for (int j = tileX; j > 0; j -= j & -j)
+      sum += density[type][i * (tileSide+1) + j];
+  }
+  return sum;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//counts a resource inside a rectangle of the map, edges included
+//whole tiles come from the tree and only the ragged edges are read block by block
+//parameters: resource type and the top left and bottom right YX co-ords.
+int Game::CountResource(int type, int y1, int x1, int y2, int x2) {
+  if (y1 < 0)
+    y1 = 0;
+  if (x1 < 0)
+    x1 = 0;
+  if (y2 > gridUpper-1)
+    y2 = gridUpper-1;
+  if (x2 > gridUpper-1)
+    x2 = gridUpper-1;
+  if (y1 > y2 || x1 > x2)
+    return 0;
+
+  //tiles that sit completely inside the rectangle
+  int tileY1 = (y1 + TILE - 1) / TILE;
+  int tileX1 = (x1 + TILE - 1) / TILE;
+  int tileY2 = (y2 + 1) / TILE;
+  int tileX2 = (x2 + 1) / TILE;
+
+  if (tileY1 >= tileY2 || tileX1 >= tileX2) //too thin to hold a whole tile
+    return ScanResource(type, y1, x1, y2, x2);
+
+  int count = DensityPrefix(type, tileY2, tileX2) - DensityPrefix(type, tileY1, tileX2)
+            - DensityPrefix(type, tileY2, tileX1) + DensityPrefix(type, tileY1, tileX1);
+
+  //top and bottom edges, full width
+  count += ScanResource(type, y1, x1, tileY1*TILE - 1, x2);
+  count += ScanResource(type, tileY2*TILE, x1, y2, x2);
+
+  //left and right edges, between the top and bottom ones
+  count += ScanResource(type, tileY1*TILE, x1, tileY2*TILE - 1, tileX1*TILE - 1);
+  count += ScanResource(type, tileY1*TILE, tileX2*TILE, tileY2*TILE - 1, x2);
+
+  return count;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//counts a resource block by block, used for the edges of a count
+int Game::ScanResource(int type, int y1, int x1, int y2, int x2) {
+  int count = 0;
+  for (int y = y1; y <= y2; y++) {
+    for (int x = x1; x <= x2; x++) {
+      if (ResourceType(grid[y][x]) == type)
+        count++;
+    }
+  }
+  return count;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//rebuilds every index from the map, called after the map is made or loaded
+void Game::BuildIndexes() {
+  BuildDensity();
+  BuildLandmarks();
+  BuildPyramid();
+  BuildClusters();
+  BuildFlows();
+  fovValid = false;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+/* LANDMARK LIST
+landmarks[0] = shops
+landmarks[1] = minibosses
+landmarks[2] = the boss
+*/
+
+//returns which landmark list holds a block, -1 if it isnt a landmark
+int Game::LandmarkType(int block) {
+  switch (block) {
+    case SHOP:
+      return 0;
+    case MINIBOSS:
+      return 1;
+    case BOSS:
+      return 2;
+    default:
+      return -1;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//sorts every shop, miniboss and the boss into the bucket lists
+void Game::BuildLandmarks() {
+  for (int type = 0; type < LANDMARKS; type++) {
+    landmarks[type].assign(bucketSide * bucketSide, std::vector<int>());
+  }
+
+  for (int y = 0; y < gridUpper; y++) {
+    for (int x = 0; x < gridUpper; x++) {
+      AddLandmark(y, x, grid[y][x]);
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//adds a block to its bucket if it is a landmark
+//parameters: YX co-ord. and the block type
+void Game::AddLandmark(int y, int x, int block) {
+  int type = LandmarkType(block);
+  if (type == -1 || landmarks[type].empty())
+    return;
+
+  landmarks[type][(y/BUCKET) * bucketSide + x/BUCKET].push_back(y * gridUpper + x);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//takes a block out of its bucket if it is a landmark, ex. a slain miniboss
+//parameters: YX co-ord. and the block type
+void Game::RemoveLandmark(int y, int x, int block) {
+  int type = LandmarkType(block);
+  if (type == -1 || landmarks[type].empty())
+    return;
+
+  std::vector<int> &bucket = landmarks[type][(y/BUCKET) * bucketSide + x/BUCKET];
+  for (long long unsigned int i = 0; i < bucket.size(); i++) {
+    if (bucket[i] == y * gridUpper + x) {
+      bucket[i] = bucket.back(); //order doesnt matter, swap with last
+      bucket.pop_back();
+      return;
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//finds the closest landmark of a type by walking rings of buckets outward
+//from the one the search starts in, stopping once no closer ring is left
+//parameters: landmark type, YX co-ord. to search from, and YX co-ord. found
+//returns the number of blocks away (up/down + left/right), -1 if none exist
+int Game::NearestLandmark(int type, int y, int x, int &foundY, int &foundX) {
+  int best = -1;
+  int bucketY = y / BUCKET;
+  int bucketX = x / BUCKET;
+
+  if (landmarks[type].empty())
+    return -1;
+
+  for (int ring = 0; ring < bucketSide; ring++) {
+    //everything in this ring is at least this far away
+    if (best != -1 && best <= (ring-1) * BUCKET)
+      break;
+
+    for (int by = bucketY - ring; by <= bucketY + ring; by++) {
+      if (by < 0 || by >= bucketSide)
+        continue;
+
+      //inner rows of the ring only have their two end buckets
+      int step = (by == bucketY - ring || by == bucketY + ring) ? 1 : 2 * ring;
+      if (step == 0)
+        step = 1;
+
+      for (int bx = bucketX - ring; bx <= bucketX + ring; bx += step) {
+        if (bx < 0 || bx >= bucketSide)
+          continue;
+
+        const std::vector<int> &bucket = landmarks[type][by * bucketSide + bx];
+        for (long long unsigned int i = 0; i < bucket.size(); i++) {
+          int ly = bucket[i] / gridUpper;
+          int lx = bucket[i] % gridUpper;
+          int distance = (ly > y ? ly - y : y - ly) + (lx > x ? lx - x : x - lx);
+
+          if (best == -1 || distance < best) {
+            best = distance;
+            foundY = ly;
+            foundX = lx;
+          }
+        }
+      }
+    }
+  }
+
+  return best;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//gives the compass direction from one spot to another
+//parameters: YX co-ord. of where you are and YX co-ord. of where to go
+std::string Game::Compass(int y, int x, int toY, int toX) {
+  bool left, right, down, up;
+  left = right = down = up = false;
+
+  if (x > toX)
+    left = true;
+  else if (x < toX)
+    right = true;
+
+  if (y > toY)
+    up = true;
+  else if (y < toY)
+    down = true;
+
+  if (up && right)
+    return "North-East";
+  else if (up && left)
+    return "North-West";
+  else if (down && left)
+    return "South-West";
+  else if (down && right)
+    return "South-East";
+  else if (up)
+    return "North";
+  else if (down)
+    return "South";
+  else if (right)
+    return "East";
+  else if (left)
+    return "West";
+  else
+    return "Error";
+}
+///////////////////////////////////////////////////////////////////////////////
+
+/* MINIMAP LIST
+pyramid[level][0] = tunnels, mined blocks and the player
+pyramid[level][1] = shops
+pyramid[level][2] = miners
+pyramid[level][3] = shops the player has seen
+*/
+
+//returns which minimap summary counts a block, -1 if it isnt summarized
+int Game::MipKind(int block) {
+  switch (block) {
+    case MINED:
+    case PLAYER:
+      return 0;
+    case SHOP:
+      return 1;
+    case MINER:
+      return 2;
+    default:
+      return -1;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//summarizes the map for the minimap, the finest level is counted from
+//the map and every level after is summed up from the one below it
+void Game::BuildPyramid() {
+  int level, kind, y, x, side, below;
+
+  for (level = 0; level < MIP_LEVELS; level++) {
+    side = (gridUpper + MIP_SCALE[level] - 1) / MIP_SCALE[level];
+    for (kind = 0; kind < MIP_KINDS; kind++)
+      pyramid[level][kind].assign(side * side, 0);
+  }
+
+  side = (gridUpper + MIP_SCALE[0] - 1) / MIP_SCALE[0];
+  for (y = 0; y < gridUpper; y++) {
+    for (x = 0; x < gridUpper; x++) {
+      kind = MipKind(grid[y][x]);
+      if (kind != -1)
+        pyramid[0][kind][(y/MIP_SCALE[0]) * side + x/MIP_SCALE[0]]++;
+      if (grid[y][x] == SHOP && IsExplored(y, x))
+        pyramid[0][3][(y/MIP_SCALE[0]) * side + x/MIP_SCALE[0]]++;
+    }
+  }
+
+  for (level = 1; level < MIP_LEVELS; level++) {
+    int ratio = MIP_SCALE[level] / MIP_SCALE[level-1];
+    side = (gridUpper + MIP_SCALE[level] - 1) / MIP_SCALE[level];
+    below = (gridUpper + MIP_SCALE[level-1] - 1) / MIP_SCALE[level-1];
+
+    for (kind = 0; kind < MIP_KINDS; kind++) {
+      for (y = 0; y < below; y++) {
+        for (x = 0; x < below; x++)
+          pyramid[level][kind][(y/ratio) * side + x/ratio] += pyramid[level-1][kind][y * below + x];
+      }
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//adds to the minimap summaries holding a block, one per level
+//parameters: YX co-ord., what kind of summary and how much to add
+void Game::UpdatePyramid(int y, int x, int kind, int amount) {
+  if (kind == -1 || pyramid[0][kind].empty())
+    return;
+
+  for (int level = 0; level < MIP_LEVELS; level++) {
+    int side = (gridUpper + MIP_SCALE[level] - 1) / MIP_SCALE[level];
+    pyramid[level][kind][(y/MIP_SCALE[level]) * side + x/MIP_SCALE[level]] += amount;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//marks a rectangle of the map as seen, a whole word of blocks at a time
+//parameters: the top left and bottom right YX co-ords., edges included
+void Game::MarkExplored(int y1, int x1, int y2, int x2) {
+  if (y1 < 0)
+    y1 = 0;
+  if (x1 < 0)
+    x1 = 0;
+  if (y2 > gridUpper-1)
+    y2 = gridUpper-1;
+  if (x2 > gridUpper-1)
+    x2 = gridUpper-1;
+  if (y1 > y2 || x1 > x2 || explored.empty())
+    return;
+
+  int first = x1 / 64;
+  int last = x2 / 64;
+  unsigned long long firstMask = ~0ULL << (x1 % 64);
+  unsigned long long lastMask = ~0ULL >> (63 - x2 % 64);
+
+  for (int y = y1; y <= y2; y++) {
+    for (int w = first; w <= last; w++) {
+      unsigned long long mask = ~0ULL;
+      if (w == first)
+        mask &= firstMask;
+      if (w == last)
+        mask &= lastMask;
+
+      ExploreWord(y, w, mask);
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//sets explored bits in one word of a row and counts the new ones
+//parameters: Y co-ord., which word of the row and the bits to set
+void Game::ExploreWord(int y, int w, unsigned long long mask) {
+  unsigned long long &word = explored[y * exploredWords + w];
+  unsigned long long fresh = mask & ~word;
+  exploredCount += __builtin_popcountll(fresh);
+  word |= mask;
+
+  //newly seen shops go on the map
+  while (fresh != 0) {
+    int x = w * 64 + __builtin_ctzll(fresh);
+    if (grid[y][x] == SHOP)
+      UpdatePyramid(y, x, 3, 1);
+    fresh &= fresh - 1;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns true if the player has seen a block
+bool Game::IsExplored(int y, int x) {
+  return (explored[y * exploredWords + x/64] >> (x % 64)) & 1;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//writes the explored bits as run lengths on one line, starting with an
+//unexplored run, so a mostly unexplored map only takes a few numbers
+void Game::SaveExplored(std::ostream &MyFile) {
+  bool bit = false;
+  long long run = 0;
+
+  MyFile << "explored";
+  for (int y = 0; y < gridUpper; y++) {
+    for (int w = 0; w < exploredWords; w++) {
+      unsigned long long word = explored[y * exploredWords + w];
+      int bits = gridUpper - w * 64 < 64 ? gridUpper - w * 64 : 64;
+      unsigned long long full = bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+
+      //whole word continues the current run
+      if ((word & full) == (bit ? full : 0)) {
+        run += bits;
+        continue;
+      }
+
+      for (int b = 0; b < bits; b++) {
+        if (((word >> b) & 1) != bit) {
+          MyFile << ',' << run;
+          run = 0;
+          bit = !bit;
+        }
+        run++;
+      }
+    }
+  }
+  MyFile << ',' << run << '\n';
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//reads the explored run lengths written by SaveExplored
+//parameters: the explored line of the save, anything else means nothing seen
+void Game::LoadExplored(std::string line) {
+  explored.assign(gridUpper * exploredWords, 0);
+  exploredCount = 0;
+
+  if (line.compare(0, 9, "explored,") != 0)
+    return;
+
+  long long position = 0;
+  long long end = (long long)gridUpper * gridUpper;
+  bool bit = false;
+  size_t i = 9;
+
+  while (i < line.size() && position < end) {
+    long long run = 0;
+    while (i < line.size() && line[i] != ',') {
+      run = run * 10 + line[i] - '0';
+      i++;
+    }
+    i++; //skips the comma
+
+    if (run > end - position)
+      run = end - position;
+
+    //explored runs are marked a row piece at a time
+    if (bit) {
+      long long start = position;
+      while (start < position + run) {
+        int y = start / gridUpper;
+        int x = start % gridUpper;
+        long long length = position + run - start;
+        if (length > gridUpper - x)
+          length = gridUpper - x;
+
+        MarkExplored(y, x, y, x + length - 1);
+        start += length;
+      }
+    }
+
+    position += run;
+    bit = !bit;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//writes every shop anyone has traded with on one line, five numbers each:
+//packed YX, ore, stock, upgrade on offer and its cost
+//parameter: stream to write to
+void Game::SaveShops(std::ostream &MyFile) {
+  MyFile << "shops";
+  for (long long unsigned int i = 0; i < shops.places.size(); i++) {
+    Shop &shop = shops.places[i];
+    if (shop.key == NO_SHOP)
+      continue;
+    MyFile << ',' << shop.key << ',' << shop.ore << ',' << (int)shop.stock;
+    MyFile << ',' << (int)shop.offer << ',' << (int)shop.cost;
+  }
+  MyFile << '\n';
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//reads the shops written by SaveShops, restocking any that were left short.
+//the landmarks have to be built first to size the table
+//parameter: the shops line of the save, anything else means no shops yet
+void Game::LoadShops(const std::string &line) {
+  ClearShops();
+  if (line.compare(0, 6, "shops,") != 0)
+    return;
+
+  int fields[5];
+  int field = 0;
+  size_t i = 6;
+
+  while (i < line.size()) {
+    int num = 0;
+    while (i < line.size() && line[i] != ',') {
+      num = num * 10 + line[i] - '0';
+      i++;
+    }
+    i++; //skips the comma
+
+    fields[field++] = num;
+    if (field < 5)
+      continue;
+    field = 0;
+
+    int y = fields[0] / gridUpper;
+    int x = fields[0] % gridUpper;
+    if (y >= gridUpper || grid[y][x] != SHOP || shops.Find(fields[0]) != NULL)
+      continue; //not a shop on this map
+
+    Shop &shop = shops.Add(fields[0]);
+    shop.ore = fields[1];
+    shop.stock = fields[2] < SHOP_STOCK ? fields[2] : SHOP_STOCK;
+    shop.offer = fields[3] < NO_OFFER ? fields[3] : NO_OFFER;
+    shop.cost = fields[4];
+    shop.restocking = false;
+    if (shop.ore > 0 || shop.stock < SHOP_STOCK)
+      QueueRestock(shop);
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//works out what the player can see, rock blocks sight but is seen itself
+//the result is kept until the player moves, their sight changes or a block
+//in range opens up or closes in, so standing still costs nothing
+//parameters: how many blocks the player can see in each direction
+void Game::UpdateFov(int sight) {
+  if (fovValid && fovY == player["y"] && fovX == player["x"] && fovRadius == sight)
+    return;
+
+  //octant multipliers for recursive shadowcasting
+  static const int mult[4][8] = {{1, 0, 0, -1, -1, 0, 0, 1},
+                                 {0, 1, -1, 0, 0, -1, 1, 0},
+                                 {0, 1, 1, 0, 0, -1, -1, 0},
+                                 {1, 0, 0, 1, -1, 0, 0, -1}};
+
+  fovY = player["y"];
+  fovX = player["x"];
+  fovRadius = sight;
+  fov.assign(2 * sight + 1, 0);
+  fov[sight] |= 1ULL << sight; //players own block
+
+  for (int octant = 0; octant < 8; octant++)
+    CastLight(1, 1.0, 0.0, mult[0][octant], mult[1][octant], mult[2][octant], mult[3][octant]);
+
+  fovValid = true;
+
+  //everything in sight is now explored, one word per row or two at most
+  for (int row = 0; row < 2 * sight + 1; row++) {
+    int y = fovY - sight + row;
+    int left = fovX - sight;
+    unsigned long long bits = fov[row];
+
+    if (bits == 0)
+      continue;
+    if (left < 0) { //off the map bits are never visible
+      bits >>= -left;
+      left = 0;
+    }
+
+    ExploreWord(y, left / 64, bits << (left % 64));
+    if (left % 64 != 0 && (bits >> (64 - left % 64)) != 0)
+      ExploreWord(y, left / 64 + 1, bits >> (64 - left % 64));
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//lights one octant row by row, splitting the light cone around rock
+//parameters: row to start from, slopes of the light cone, octant multipliers
+void Game::CastLight(int row, double start, double end, int xx, int xy, int yx, int yy) {
+  double newStart = 0;
+
+  if (start < end)
+    return;
+
+  for (int j = row; j <= fovRadius; j++) {
+    int dx = -j - 1;
+    int dy = -j;
+    bool blocked = false;
+
+    while (dx <= 0) {
+      dx++;
+      int x = fovX + dx * xx + dy * xy;
+      int y = fovY + dx * yx + dy * yy;
+      double leftSlope = (dx - 0.5) / (dy + 0.5);
+      double rightSlope = (dx + 0.5) / (dy - 0.5);
+
+      if (start < rightSlope)
+        continue;
+      else if (end > leftSlope)
+        break;
+
+      //the edge of the map blocks sight and isnt seen
+      bool inside = y >= 0 && y < gridUpper && x >= 0 && x < gridUpper;
+      bool opaque = !inside || OPAQUE[grid[y][x]];
+      if (inside)
+        fov[y - fovY + fovRadius] |= 1ULL << (x - fovX + fovRadius);
+
+      if (blocked) {
+        if (opaque) {
+          newStart = rightSlope;
+          continue;
+        }
+        blocked = false;
+        start = newStart;
+      }
+      else if (opaque && j < fovRadius) {
+        blocked = true;
+        CastLight(j + 1, start, leftSlope, xx, xy, yx, yy);
+        newStart = rightSlope;
+      }
+    }
+
+    if (blocked)
+      break;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns true if the block is in the players current field of view
+bool Game::IsVisible(int y, int x) {
+  if (y < fovY - fovRadius || y > fovY + fovRadius ||
+      x < fovX - fovRadius || x > fovX + fovRadius)
+    return false;
+
+  return (fov[y - fovY + fovRadius] >> (x - fovX + fovRadius)) & 1;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns how many steps it costs travel to walk into a block, -1 if it cant
+//miners count as tunnels here since they never stay put, the path
+//around them is found when the path is walked
+int Game::TravelCost(int block) {
+  switch (block) {
+    case PLAYER:
+    case MINED:
+    case MINER:
+      return 1;
+    case DIRT:
+    case ORE:
+    case ARTIFACT:
+      return DIG_COST;
+    default: //shops and monsters are only walked into on purpose
+      return -1;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns what it costs to walk into a block on the way to a goal, a shop
+//or monster can be walked into if it is the goal itself
+//parameters: packed YX of the block and of the goal
+int Game::StepCost(int cell, int goal) {
+  int cost = TravelCost(grid[cell / gridUpper][cell % gridUpper]);
+  if (cost == -1 && cell == goal)
+    return 1;
+  return cost;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//marks every travel summary as out of date, they are made when needed
+void Game::BuildClusters() {
+  clusters.assign(clusterSide * clusterSide, Cluster());
+  for (long long unsigned int i = 0; i < clusters.size(); i++) {
+    clusters[i].dug = 0;
+    clusters[i].dirty = true;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//marks the cluster of a changed block out of date, and its neighbour too if
+//the block is on their shared edge since their entrances match up.
+//blocks only get cheaper to walk once dug, so a summary stays a safe guess
+//for a while and is only made again after a line of blocks is dug out.
+//parameters: YX co-ord. of the changed block and if it opened up or closed
+void Game::DirtyClusters(int y, int x, bool opened) {
+  int cy = y / CLUSTER;
+  int cx = x / CLUSTER;
+
+  if (clusters.empty())
+    return;
+
+  if (!opened) {
+    if (++clusters[cy * clusterSide + cx].dug >= CLUSTER)
+      clusters[cy * clusterSide + cx].dirty = true;
+    return;
+  }
+
+  clusters[cy * clusterSide + cx].dirty = true;
+  if (y % CLUSTER == 0 && cy > 0)
+    clusters[(cy-1) * clusterSide + cx].dirty = true;
+  if (y % CLUSTER == CLUSTER-1 && cy < clusterSide-1)
+    clusters[(cy+1) * clusterSide + cx].dirty = true;
+  if (x % CLUSTER == 0 && cx > 0)
+    clusters[cy * clusterSide + cx-1].dirty = true;
+  if (x % CLUSTER == CLUSTER-1 && cx < clusterSide-1)
+    clusters[cy * clusterSide + cx+1].dirty = true;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns a clusters travel summary, making it again first if it is out of date
+//parameters: YX co-ord. of the cluster
+Cluster &Game::GetCluster(int cy, int cx) {
+  Cluster &cluster = clusters[cy * clusterSide + cx];
+  if (!cluster.dirty)
+    return cluster;
+
+  cluster.nodes.clear();
+  cluster.sides.clear();
+  for (int side = 1; side <= 8; side *= 2)
+    FindEntrances(cy, cx, side, cluster);
+
+  //cheapest way between each pair of entrances inside the cluster
+  int count = cluster.nodes.size();
+  std::vector<int> local;
+  cluster.dist.assign(count * count, -1);
+
+  for (int i = 0; i < count; i++) {
+    ClusterDijkstra(cluster.nodes[i], -1, false, local);
+    for (int j = 0; j < count; j++) {
+      int y = cluster.nodes[j] / gridUpper;
+      int x = cluster.nodes[j] % gridUpper;
+      cluster.dist[i * count + j] = local[(y % CLUSTER) * CLUSTER + x % CLUSTER];
+    }
+  }
+
+  cluster.dug = 0;
+  cluster.dirty = false;
+  return cluster;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//finds the entrances on one edge of a cluster, every run of open blocks
+//facing open blocks across the edge gets one in the middle, or one at each
+//end if it is long. both clusters find the same ones for a shared edge
+//parameters: YX co-ord. of the cluster, which edge and the cluster to add to
+void Game::FindEntrances(int cy, int cx, int side, Cluster &cluster) {
+  int top = cy * CLUSTER;
+  int left = cx * CLUSTER;
+  int bottom = std::min(top + CLUSTER, gridUpper) - 1;
+  int right = std::min(left + CLUSTER, gridUpper) - 1;
+  int y, x, acrossY, acrossX, length;
+
+  //the edge as a line of blocks with a step across it
+  if (side == 1 && cy > 0) {
+    y = top; x = left; acrossY = -1; acrossX = 0; length = right - left + 1;
+  } else if (side == 2 && cx > 0) {
+    y = top; x = left; acrossY = 0; acrossX = -1; length = bottom - top + 1;
+  } else if (side == 4 && cy < clusterSide-1) {
+    y = bottom; x = left; acrossY = 1; acrossX = 0; length = right - left + 1;
+  } else if (side == 8 && cx < clusterSide-1) {
+    y = top; x = right; acrossY = 0; acrossX = 1; length = bottom - top + 1;
+  } else
+    return; //edge of the map
+
+  int alongY = acrossX != 0 ? 1 : 0;
+  int alongX = acrossY != 0 ? 1 : 0;
+  int start = -1;
+
+  for (int i = 0; i <= length; i++) {
+    bool open = false;
+    if (i < length) {
+      int by = y + i * alongY;
+      int bx = x + i * alongX;
+      open = TravelCost(grid[by][bx]) != -1 &&
+             TravelCost(grid[by + acrossY][bx + acrossX]) != -1;
+    }
+
+    if (open && start == -1)
+      start = i;
+    else if (!open && start != -1) {
+      //run of open blocks from start to i-1
+      int picks[2] = {(start + i - 1) / 2, -1};
+      if (i - start >= 6) {
+        picks[0] = start;
+        picks[1] = i - 1;
+      }
+
+      for (int p = 0; p < 2 && picks[p] != -1; p++) {
+        int cell = (y + picks[p] * alongY) * gridUpper + x + picks[p] * alongX;
+        long long unsigned int n = 0;
+        while (n < cluster.nodes.size() && cluster.nodes[n] != cell)
+          n++;
+
+        if (n == cluster.nodes.size()) { //corners can be on two edges
+          cluster.nodes.push_back(cell);
+          cluster.sides.push_back(0);
+        }
+        cluster.sides[n] |= side;
+      }
+      start = -1;
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//cheapest cost from one block to every block of its cluster, staying inside
+//when reverse is set it is the cost from every block to that one instead.
+//steps only cost 1 to DIG_COST so a ring of buckets stands in for a heap
+//parameters: packed YX to start from, a blocked block that may be walked
+//into as the goal (-1 if none), the direction and the costs by local block
+void Game::ClusterDijkstra(int from, int goal, bool reverse, std::vector<int> &dist) {
+  int cy = (from / gridUpper) / CLUSTER;
+  int cx = (from % gridUpper) / CLUSTER;
+  int top = cy * CLUSTER;
+  int left = cx * CLUSTER;
+  int bottom = std::min(top + CLUSTER, gridUpper) - 1;
+  int right = std::min(left + CLUSTER, gridUpper) - 1;
+  const int stepY[4] = {-1, 0, 1, 0};
+  const int stepX[4] = {0, -1, 0, 1};
+
+  std::vector<int> buckets[DIG_COST + 1];
+  int waiting = 1;
+  dist.assign(CLUSTER * CLUSTER, -1);
+
+  int y = from / gridUpper;
+  int x = from % gridUpper;
+  dist[(y - top) * CLUSTER + x - left] = 0;
+  buckets[0].push_back(from);
+
+  for (int cost = 0; waiting > 0; cost++) {
+    std::vector<int> &bucket = buckets[cost % (DIG_COST + 1)];
+
+    for (long long unsigned int b = 0; b < bucket.size(); b++) {
+      int cell = bucket[b];
+      waiting--;
+
+      y = cell / gridUpper;
+      x = cell % gridUpper;
+      if (cost > dist[(y - top) * CLUSTER + x - left])
+        continue; //already found cheaper
+
+      //the goal is walked into but never through
+      if (cell == goal && cell != from)
+        continue;
+
+      for (int d = 0; d < 4; d++) {
+        int ny = y + stepY[d];
+        int nx = x + stepX[d];
+        if (ny < top || ny > bottom || nx < left || nx > right)
+          continue;
+
+        //forwards it costs to walk into the next block, in reverse this one
+        int next = ny * gridUpper + nx;
+        int step = reverse ? StepCost(cell, goal) : StepCost(next, goal);
+        if (step == -1 || StepCost(next, goal) == -1)
+          continue;
+
+        int &best = dist[(ny - top) * CLUSTER + nx - left];
+        if (best == -1 || cost + step < best) {
+          best = cost + step;
+          buckets[best % (DIG_COST + 1)].push_back(next);
+          waiting++;
+        }
+      }
+    }
+    bucket.clear();
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//finds the block by block way between two blocks with A* inside a box of
+//the map, going around miners standing in the way this time
+//parameters: packed YX of both ends, the goal block, the top left and bottom
+//right YX co-ords. of the box and the path to add to
+bool Game::RefinePath(int from, int to, int goal, int top, int left, int bottom, int right,
+                       std::vector<int> &path) {
+  int width = right - left + 1;
+  int toY = to / gridUpper;
+  int toX = to % gridUpper;
+  const int stepY[4] = {-1, 0, 1, 0};
+  const int stepX[4] = {0, -1, 0, 1};
+
+  std::vector<int> dist(width * (bottom - top + 1), -1);
+  std::vector<int> parent(width * (bottom - top + 1), -1);
+  std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                      std::greater<std::pair<int, int>>> open;
+
+  int y = from / gridUpper;
+  int x = from % gridUpper;
+  dist[(y - top) * width + x - left] = 0;
+  open.push(std::make_pair(std::abs(y - toY) + std::abs(x - toX), from));
+
+  while (!open.empty()) {
+    int guess = open.top().first;
+    int cell = open.top().second;
+    open.pop();
+    if (cell == to)
+      break;
+
+    y = cell / gridUpper;
+    x = cell % gridUpper;
+    int cost = dist[(y - top) * width + x - left];
+    if (guess > cost + std::abs(y - toY) + std::abs(x - toX))
+      continue; //already found cheaper
+
+    for (int d = 0; d < 4; d++) {
+      int ny = y + stepY[d];
+      int nx = x + stepX[d];
+      int next = ny * gridUpper + nx;
+      if (ny < top || ny > bottom || nx < left || nx > right)
+        continue;
+
+      int step = StepCost(next, goal);
+      if (step == -1 || (grid[ny][nx] == MINER && next != goal))
+        continue;
+
+      int &best = dist[(ny - top) * width + nx - left];
+      if (best == -1 || cost + step < best) {
+        best = cost + step;
+        parent[(ny - top) * width + nx - left] = cell;
+        open.push(std::make_pair(best + std::abs(ny - toY) + std::abs(nx - toX), next));
+      }
+    }
+  }
+
+  if (dist[(toY - top) * width + toX - left] == -1)
+    return false;
+
+  //walks back from the end and flips it around
+  size_t first = path.size();
+  for (int cell = to; cell != from; ) {
+    path.push_back(cell);
+    cell = parent[(cell / gridUpper - top) * width + cell % gridUpper - left];
+  }
+  std::reverse(path.begin() + first, path.end());
+  return true;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//finds a way from one block to another, first across cluster entrances
+//and then block by block between each pair of entrances
+//parameters: YX co-ord. to start from, YX co-ord. to reach and the path
+//of packed YX it fills, not counting the start
+bool Game::FindPath(int y, int x, int goalY, int goalX, std::vector<int> &path) {
+  int start = y * gridUpper + x;
+  int goal = goalY * gridUpper + goalX;
+  int goalCluster = (goalY / CLUSTER) * clusterSide + goalX / CLUSTER;
+  const int stepY[4] = {-1, 0, 1, 0};
+  const int stepX[4] = {0, -1, 0, 1};
+  std::vector<int> startDist, goalDist;
+
+  path.clear();
+  if (start == goal)
+    return true;
+
+  //short trips are searched block by block straight away
+  if (std::abs(y - goalY) + std::abs(x - goalX) <= CLUSTER) {
+    int top = std::max(std::min(y, goalY) - CLUSTER/2, 0);
+    int left = std::max(std::min(x, goalX) - CLUSTER/2, 0);
+    int bottom = std::min(std::max(y, goalY) + CLUSTER/2, gridUpper-1);
+    int right = std::min(std::max(x, goalX) + CLUSTER/2, gridUpper-1);
+
+    if (RefinePath(start, goal, goal, top, left, bottom, right, path))
+      return true;
+    path.clear();
+  }
+
+  //ways out of the start and into the goal, in their own clusters
+  ClusterDijkstra(start, goal, false, startDist);
+  ClusterDijkstra(goal, goal, true, goalDist);
+
+  std::unordered_map<int, int> cost; //cheapest cost found to each entrance
+  std::unordered_map<int, int> parent;
+  std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                      std::greater<std::pair<int, int>>> open;
+
+  cost[start] = 0;
+  open.push(std::make_pair(TRAVEL_GREED * (std::abs(y - goalY) + std::abs(x - goalX)), start));
+
+  while (!open.empty()) {
+    int guess = open.top().first;
+    int cell = open.top().second;
+    open.pop();
+    if (cell == goal)
+      break;
+
+    int cy = (cell / gridUpper) / CLUSTER;
+    int cx = (cell % gridUpper) / CLUSTER;
+    int here = cost[cell];
+    if (guess > here + TRAVEL_GREED * (std::abs(cell / gridUpper - goalY) + std::abs(cell % gridUpper - goalX)))
+      continue; //already found cheaper
+
+    Cluster &cluster = GetCluster(cy, cx);
+    int count = cluster.nodes.size();
+    std::vector<std::pair<int, int>> edges; //next block and what it costs
+
+    int i = 0;
+    while (i < count && cluster.nodes[i] != cell)
+      i++;
+
+    if (cell == start) {
+      for (int j = 0; j < count; j++) {
+        int ny = cluster.nodes[j] / gridUpper;
+        int nx = cluster.nodes[j] % gridUpper;
+        int c = startDist[(ny % CLUSTER) * CLUSTER + nx % CLUSTER];
+        if (c != -1)
+          edges.push_back(std::make_pair(cluster.nodes[j], c));
+      }
+    }
+
+    //entrances lead to the other entrances and across the edge, the
+    //start can be an entrance too
+    if (i < count) {
+      for (int j = 0; j < count; j++) {
+        if (j != i && cluster.dist[i * count + j] != -1)
+          edges.push_back(std::make_pair(cluster.nodes[j], cluster.dist[i * count + j]));
+      }
+
+      //step across each edge this entrance is on
+      for (int d = 0; d < 4; d++) {
+        if (!(cluster.sides[i] & (1 << d)))
+          continue;
+        int ny = cell / gridUpper + stepY[d];
+        int nx = cell % gridUpper + stepX[d];
+        GetCluster(ny / CLUSTER, nx / CLUSTER); //keeps both sides in step
+        edges.push_back(std::make_pair(ny * gridUpper + nx, TravelCost(grid[ny][nx])));
+      }
+    }
+
+    //straight into the goal from inside its cluster
+    if (cy * clusterSide + cx == goalCluster) {
+      int c = goalDist[(cell / gridUpper % CLUSTER) * CLUSTER + cell % gridUpper % CLUSTER];
+      if (c != -1)
+        edges.push_back(std::make_pair(goal, c));
+    }
+
+    for (long long unsigned int e = 0; e < edges.size(); e++) {
+      int next = edges[e].first;
+      if (grid[next / gridUpper][next % gridUpper] == MINER && next != goal)
+        continue; //a miner is standing on it right now
+
+      std::unordered_map<int, int>::iterator found = cost.find(next);
+      if (found == cost.end() || here + edges[e].second < found->second) {
+        cost[next] = here + edges[e].second;
+        parent[next] = cell;
+        int ny = next / gridUpper;
+        int nx = next % gridUpper;
+        open.push(std::make_pair(cost[next] + TRAVEL_GREED * (std::abs(ny - goalY) + std::abs(nx - goalX)), next));
+      }
+    }
+  }
+
+  if (cost.find(goal) == cost.end())
+    return false;
+
+  //entrances from the goal back to the start
+  std::vector<int> waypoints;
+  for (int cell = goal; cell != start; cell = parent[cell])
+    waypoints.push_back(cell);
+  waypoints.push_back(start);
+  std::reverse(waypoints.begin(), waypoints.end());
+
+  //block by block between them, steps across an edge are already adjacent
+  for (long long unsigned int w = 1; w < waypoints.size(); w++) {
+    int from = waypoints[w-1];
+    int to = waypoints[w];
+    int apart = std::abs(from / gridUpper - to / gridUpper) + std::abs(from % gridUpper - to % gridUpper);
+
+    //both ends are in the cluster of the first one
+    int top = (from / gridUpper) / CLUSTER * CLUSTER;
+    int left = (from % gridUpper) / CLUSTER * CLUSTER;
+    int bottom = std::min(top + CLUSTER, gridUpper) - 1;
+    int right = std::min(left + CLUSTER, gridUpper) - 1;
+
+    if (apart == 1)
+      path.push_back(to);
+    else if (!RefinePath(from, to, goal, top, left, bottom, right, path))
+      return false;
+  }
+  return true;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//walks the player to a block one step at a time, miners moving with each
+//step, until they get there or something gets in the way
+//parameters: YX co-ord. to travel to
+bool Game::Travel(int y, int x) {
+  std::vector<int> path;
+
+  if (!FindPath(player["y"], player["x"], y, x, path)) {
+    Emit(NO_PATH_EVENT, 0);
+    return false;
+  }
+
+  Emit(TRAVEL_EVENT, path.size());
+
+  for (long long unsigned int i = 0; i < path.size(); i++) {
+    int nextY = path[i] / gridUpper;
+    int nextX = path[i] % gridUpper;
+    int health = player["health"];
+    int direction;
+
+    if (nextY < player["y"])
+      direction = 0;
+    else if (nextX < player["x"])
+      direction = 1;
+    else if (nextY > player["y"])
+      direction = 2;
+    else
+      direction = 3;
+
+    Move(direction);
+    if (scene.kind != NO_SCENE)
+      return true; //the scene plays out before anyone else moves
+    MoveMiners();
+
+    //stops if the step didnt happen or a miner got a swing in
+    if (!game || player["y"] != nextY || player["x"] != nextX || player["health"] < health) {
+      Emit(STOPPED_EVENT, 0);
+      return false;
+    }
+  }
+  return false;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//throws away every shop flow field, they are made when a miner needs one
+void Game::BuildFlows() {
+  flows.assign(regionSide * regionSide, std::vector<unsigned short>());
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//throws away the flow fields that can reach a changed shop or monster
+//parameters: YX co-ord. of the changed block
+void Game::DirtyFlows(int y, int x) {
+  if (flows.empty())
+    return;
+
+  //every region whose field with its apron covers the block
+  int top = std::max(y - FLOW_APRON, 0) / FLOW_REGION;
+  int left = std::max(x - FLOW_APRON, 0) / FLOW_REGION;
+  int bottom = std::min(y + FLOW_APRON, gridUpper-1) / FLOW_REGION;
+  int right = std::min(x + FLOW_APRON, gridUpper-1) / FLOW_REGION;
+
+  for (int ry = top; ry <= bottom; ry++) {
+    for (int rx = left; rx <= right; rx++)
+      flows[ry * regionSide + rx].clear();
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns how many steps a block is from the nearest shop by its regions
+//flow field, making the field first if needed. one breadth first search
+//from every shop in the region and its apron serves all its miners
+//parameters: YX co-ord. of the block
+int Game::FlowDistance(int y, int x) {
+  int ry = y / FLOW_REGION;
+  int rx = x / FLOW_REGION;
+  std::vector<unsigned short> &flow = flows[ry * regionSide + rx];
+
+  if (flow.empty()) {
+    //the region plus its apron, clipped to the map
+    int top = std::max(ry * FLOW_REGION - FLOW_APRON, 0);
+    int left = std::max(rx * FLOW_REGION - FLOW_APRON, 0);
+    int bottom = std::min((ry+1) * FLOW_REGION + FLOW_APRON, gridUpper) - 1;
+    int right = std::min((rx+1) * FLOW_REGION + FLOW_APRON, gridUpper) - 1;
+    int width = right - left + 1;
+    const int stepY[4] = {-1, 0, 1, 0};
+    const int stepX[4] = {0, -1, 0, 1};
+
+    static thread_local std::vector<unsigned short> field;
+    static thread_local std::vector<int> queue;
+    field.assign(width * (bottom - top + 1), FLOW_NONE);
+    queue.clear();
+
+    for (int by = top; by <= bottom; by++) {
+      for (int bx = left; bx <= right; bx++) {
+        if (grid[by][bx] == SHOP) {
+          field[(by - top) * width + bx - left] = 0;
+          queue.push_back((by - top) * width + bx - left);
+        }
+      }
+    }
+
+    //miners dig through anything but monsters
+    for (long long unsigned int i = 0; i < queue.size(); i++) {
+      int cy = queue[i] / width;
+      int cx = queue[i] % width;
+
+      for (int d = 0; d < 4; d++) {
+        int ny = cy + stepY[d];
+        int nx = cx + stepX[d];
+        if (ny < 0 || ny > bottom - top || nx < 0 || nx >= width)
+          continue;
+        if (field[ny * width + nx] != FLOW_NONE)
+          continue;
+
+        int block = grid[ny + top][nx + left];
+        if (block == MINIBOSS || block == BOSS)
+          continue;
+
+        field[ny * width + nx] = field[cy * width + cx] + 1;
+        queue.push_back(ny * width + nx);
+      }
+    }
+
+    //only the region itself is kept
+    int height = std::min(FLOW_REGION, gridUpper - ry * FLOW_REGION);
+    int across = std::min(FLOW_REGION, gridUpper - rx * FLOW_REGION);
+    flow.resize(FLOW_REGION * FLOW_REGION);
+    for (int fy = 0; fy < height; fy++) {
+      for (int fx = 0; fx < across; fx++) {
+        int by = ry * FLOW_REGION + fy - top;
+        int bx = rx * FLOW_REGION + fx - left;
+        flow[fy * FLOW_REGION + fx] = field[by * width + bx];
+      }
+    }
+  }
+
+  return flow[(y % FLOW_REGION) * FLOW_REGION + x % FLOW_REGION];
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns the direction that takes a miner closer to a shop, -1 if none does
+//parameters: miner looking for a shop
+int Game::FlowDirection(Rogue &miner) {
+  const int stepY[4] = {-1, 0, 1, 0};
+  const int stepX[4] = {0, -1, 0, 1};
+  int best = FlowDistance(miner.y, miner.x);
+  int direction = -1;
+
+  if (best == FLOW_NONE)
+    return -1;
+
+  for (int d = 0; d < 4; d++) {
+    int y = miner.y + stepY[d];
+    int x = miner.x + stepX[d];
+    if (y < 0 || y >= gridUpper || x < 0 || x >= gridUpper)
+      continue;
+
+    int distance = FlowDistance(y, x);
+    if (distance < best) {
+      best = distance;
+      direction = d;
+    }
+  }
+  return direction;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//takes several steps in one direction without drawing the map in between,
+//stopping early when ore or artifacts are found, the player is blocked or hurt,
+//or a shop, miner or boss comes into sight. only the miners that could reach
+//the player move with every step, the rest catch up all at once at the end
+//parameters: direction to move in and the most steps to take
+//returns true if a scene started and the miners still need their turn
+bool Game::Run(int direction, int steps) {
+  int sight = upgrades[1] + 4;
+  //a miner moves every other turn, so further than this it can't meet the player
+  int reach = steps + (steps + 1) / 2 + 1;
+  int startY = player["y"];
+  int startX = player["x"];
+  std::pmr::vector<int> owed(minerCount, 0, &scratch); //moves put off per miner
+
+  UpdateFov(sight);
+  int sighted = CountSighted(sight);
+  int taken = 0;
+  bool spotted = false;
+
+  while (taken < steps) {
+    int y = player["y"];
+    int x = player["x"];
+    int health = player["health"];
+    int ore = player["ore"];
+    int artifacts = player["artifacts"];
+
+    Move(direction);
+    if (scene.kind != NO_SCENE)
+      break; //the scene plays out before anyone else moves
+
+    {
+      ProfileScope scope(MINERS_PHASE); //each steps miners are a batch of their own
+      RunTimers(&owed, startY, startX, reach);
+    }
+    taken++;
+
+    if (!game || (player["y"] == y && player["x"] == x) || player["health"] < health ||
+        player["ore"] > ore || player["artifacts"] > artifacts)
+      break;
+
+    UpdateFov(sight); //keeps the map of explored blocks whole
+    int count = CountSighted(sight);
+    if (count > sighted) {
+      spotted = true;
+      break;
+    }
+    sighted = count;
+  }
+
+  {
+    ProfileScope scope(MINERS_PHASE); //the put off moves are one more batch
+    for (long long unsigned int i = 0; i < MinerList.size(); i++)
+      for (int turn = 0; turn < owed[i]; turn++)
+        MoveMiner(MinerList[i]);
+  }
+
+  if (spotted)
+    Emit(SPOTTED_EVENT, 0);
+  return scene.kind != NO_SCENE;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//returns how many shops, miners and bosses the player can see
+//parameter: how far the player can see
+int Game::CountSighted(int sight) {
+  int count = 0;
+
+  for (int y = player["y"] - sight; y <= player["y"] + sight; y++) {
+    for (int x = player["x"] - sight; x <= player["x"] + sight; x++) {
+      if (y < 0 || y >= gridUpper || x < 0 || x >= gridUpper || !IsVisible(y, x))
+        continue;
+      if (grid[y][x] == SHOP || grid[y][x] == MINER || grid[y][x] == MINIBOSS || grid[y][x] == BOSS)
+        count++;
+    }
+  }
+  return count;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//starts a scene and plays it up to its first question
+//parameters: scene type and the YX co-ord. of the block it happens at
+void Game::StartScene(int kind, int y, int x) {
+  scene = Scene();
+  scene.kind = kind;
+  scene.y = y;
+  scene.x = x;
+  scene.started = ProfileNow();
+  PlayScene(""); //the turn that started it may still be using its scratch
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//hands the players answer to the scene playing so it can go on, with fresh
+//scratch if whatever the scene said before has been shown
+//parameter: players answer to the last question
+void Game::StepScene(const std::string &answer) {
+  ClearScratch();
+  PlayScene(answer);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//plays the scene on up to its next question or its end
+//parameter: players answer to the last question
+void Game::PlayScene(const std::string &answer) {
+  switch (scene.kind) {
+    case SHOP_SCENE:
+      CallShop(answer);
+      break;
+    case FIGHT_SCENE:
+      MinerFight(answer);
+      break;
+    case MINIBOSS_SCENE:
+      Miniboss(answer);
+      break;
+    case BOSS_SCENE:
+      Boss(answer);
+      break;
+    case REVIVE_SCENE:
+      Revive(answer);
+      break;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//lets what the scene said so far sit for a while before it goes on
+//parameter: seconds to wait
+void Game::Pause(double seconds) {
+  Event event = {SAY_EVENT, 0, std::move(sceneText), seconds}; //stays in scratch
+  events.push_back(std::move(event));
+  sceneText.clear();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//stops the scene to wait for the players answer
+//parameter: step the scene picks up at with the answer
+void Game::Ask(int step) {
+  Pause(0);
+  scene.step = step;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//finishes the scene, whatever it said is still shown
+void Game::EndScene() {
+  if (profiling || tracing)
+    ProfileSpan(SCENE_PHASE, scene.started);
+  Pause(0);
+  scene.kind = NO_SCENE;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//moves the player into a block they won the right to
+//parameters: YX co-ord. of the block
+void Game::EnterBlock(int y, int x) {
+  SetBlock(y, x, PLAYER);
+  SetBlock(player["y"], player["x"], MINED);
+  player["y"] = y;
+  player["x"] = x;
+}
@@ -0,0 +1,290 @@
+//The Deep Below
+//simulation core: the mines, the player, the miners, the shops and the fights.
+//nothing in here reads input or prints, front ends drive a Game through Act,
+//StepScene and EndTurn and show the events it leaves, clearing them once shown
+
+#ifndef CORE_H
+#define CORE_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include <queue>
+#include <sstream>
+#include <random>
+#include <unordered_map>
+#include <iosfwd>
+
+#include "world.h"
+#include "arena.h"
+#include "wheel.h"
+#include "shops.h"
+
+
+//enemy AI class
+struct Rogue {
+  int damage, coins, ore, artifacts, health, x, y, direction;
+  int pace;  //turns between moves
+  int timer; //handle of the timer for its next move
+};
+
+//travel pathfinding summary of one block of the map
+struct Cluster {
+  std::vector<int> nodes; //packed YX of entrance blocks on the cluster edges
+  std::vector<int> sides; //edges each node is an entrance on, 1 up 2 left 4 down 8 right
+  std::vector<int> dist;  //cheapest cost between every pair of nodes, -1 if no way
+  int  dug;               //blocks dug out since the last summary
+  bool dirty;             //true when the summary has to be made again
+};
+
+//a shop visit or fight that plays out one answer at a time
+struct Scene {
+  int  kind;         //scene type playing, NO_SCENE when there is none
+  int  step;         //where the scene picks up with the next answer
+  int  y, x;         //block the scene happens at
+  int  health;       //enemy health in fights
+  int  damage;       //enemy damage in fights
+  int  cost, offer;  //the shops deal of the day
+  bool asked;        //the shop only offers its deal once
+  bool final;        //the miniboss is standing in for the boss
+  long long started; //when the scene began, for the profiler
+};
+
+//something that happened for the front end to show
+struct Event {
+  int  type;         //event type, see below
+  int  value;        //amount that goes with it, ex. damage taken
+  std::pmr::string text; //what a scene said, only for SAY_EVENT, kept in scratch
+  double seconds;    //how long to let it sit before going on
+};
+
+
+//memory one part of the game holds, for the memory report
+struct MemoryPart {
+  std::string name;
+  long long bytes;   //heap held, capacity not just what is used
+  std::string note;  //what it is holding, ex. how many miners are alive
+};
+
+//how a miniboss fight is expected to end when one strategy is kept to
+struct Odds {
+  double win;        //chance the monster goes down first
+  double escape;     //chance of getting away, only running can
+  double hp;         //health expected to be left, dying counts as 0
+};
+
+
+//Constants
+static const int DEFAULT_GRID = 2000; //2000x2000 grid, 4 million blocks, saves can be other sizes
+static const int UPGRADE_UPPER = 7; //num of upgrades implemented
+static const int UPGRADE_TOP = 3; //highest level an upgrade reaches
+static const int MINERS_PER_SIDE = 3; //miners for each block a side of the map
+static const int TILE = 8; //density index counts the map in 8x8 tiles
+static const int RESOURCES = 3; //ore, artifacts and miners are counted
+static const int PROSPECT_RANGE = 50; //how far the prospect command listens
+static const int BUCKET = 32; //landmark index sorts the map into 32x32 buckets
+static const int LANDMARKS = 3; //shops, minibosses and the boss are indexed
+static const int MIP_LEVELS = 3; //minimap summaries of 8x8, 64x64 and 512x512 blocks
+static const int MIP_KINDS = 4; //tunnels, shops, miners and known shops are summarized
+static const int MIP_SCALE[MIP_LEVELS] = {8, 64, 512}; //blocks per summary side
+static const int MINIMAP_SIZE = 32; //minimap panels are 32x32
+static const int CLUSTER = 32; //travel pathfinding groups the map into 32x32 clusters
+static const int DIG_COST = 3; //travel prefers tunnels, digging a block costs 3 steps
+static const int TRAVEL_GREED = 2; //weights the distance left when searching entrances
+static const int FLOW_REGION = 64; //miners share one shop flow field per 64x64 region
+static const int FLOW_APRON = 16; //fields also count shops this far outside their region
+static const unsigned short FLOW_NONE = 65535; //no shop in reach of the field
+static const int RUN_LIMIT = 100; //most steps one run command will take
+static const int RESPAWN_TURNS = 20; //a fallen miner is replaced about 20 turns later
+static const int MINER_PACE = 2; //miners move every other turn
+static const int ORE_PRICE = 5; //coins a shop pays for ore when it has none
+static const int ORE_GLUT = 10; //every 10 ore a shop is sitting on takes a coin off
+static const int ARTIFACT_PRICE = 30; //coins a shop wants for an artifact
+static const int SHOP_STOCK = 10; //artifacts a shop has for sale when fully stocked
+static const int RESTOCK_TURNS = 25; //a shop ships off ORE_GLUT ore and gets an artifact in this often
+static const int NO_OFFER = UPGRADE_UPPER; //the shops upgrade has been sold
+
+//"block" types
+#define PLAYER   0
+#define DIRT     1
+#define MINED    2 //mined dirt
+#define SHOP     3
+#define ARTIFACT 4
+#define ORE      5
+#define MINER    6 //enemy
+#define MINIBOSS 7
+#define BOSS     8
+#define EDGE     9 //past the edge of the map, nothing goes in or out
+
+//what each block type is like, looked up instead of branched on
+static const int BLOCK_TYPES = 10;
+static constexpr bool OPAQUE[BLOCK_TYPES] = {false, true, false, false, true, true, false, false, false, true}; //blocks sight
+static constexpr char GLYPH[BLOCK_TYPES] = {'P', '#', ' ', '$', '#', '#', '+', '"', '-', ' '}; //shown on the map, ore and artifacts glint now and then
+static constexpr int LOOT[BLOCK_TYPES] = {-1, 2, -1, -1, 1, 0, -1, -1, -1, -1}; //what the digging upgrades get out of it, 0 ore 1 artifact 2 dirt, -1 left alone
+
+//scene types
+#define NO_SCENE       0
+#define SHOP_SCENE     1
+#define FIGHT_SCENE    2 //enemy miner
+#define MINIBOSS_SCENE 3
+#define BOSS_SCENE     4
+#define REVIVE_SCENE   5
+
+//event types
+#define SAY_EVENT      0 //a scene said something
+#define ORE_EVENT      1 //player dug up ore
+#define ARTIFACT_EVENT 2 //player dug up an artifact
+#define HIT_EVENT      3 //a miner walked into the player, value is the damage
+#define SLAIN_EVENT    4 //that miner finished the player off
+#define TRAVEL_EVENT   5 //travel set off, value is the blocks to go
+#define NO_PATH_EVENT  6 //travel couldnt find a way
+#define STOPPED_EVENT  7 //travel was cut short
+#define SPOTTED_EVENT  8 //a run stopped for something in sight
+#define MARK_EVENT     9 //player marked their spot
+#define NO_MARK_EVENT  10 //player tried to go back to a mark they never made
+
+
+//one game of The Deep Below, everything the mines remember
+struct Game {
+  bool game; //game on/off
+  int  gridUpper; //blocks per side of the map
+  int  minerCount; //most miners on the map at once, scales with grid size
+  int  tileSide, bucketSide, clusterSide, regionSide; //density tiles, landmark buckets,
+                                                      //clusters and flow regions per side
+  int  exploredWords; //64 explored bits per word, words per row
+  int  upgrades[UPGRADE_UPPER]; //stores levels of upgrades
+  std::map<std::string, int> player; //dictionary of player items, defined in Init()
+  World<unsigned char> grid; //map, a block a byte
+  std::vector<Rogue> MinerList; //living enemy miners, packed
+  std::vector<int> density[RESOURCES]; //2d fenwick trees of tile counts
+  std::vector<std::vector<int>> landmarks[LANDMARKS]; //packed YX per bucket
+  std::vector<int> pyramid[MIP_LEVELS][MIP_KINDS]; //minimap block summaries
+  std::vector<unsigned long long> explored; //1 bit per block the player has seen
+  long long exploredCount; //number of bits set in explored
+  std::vector<unsigned long long> fov; //rows of visible bits around fovY, fovX
+  int  fovY, fovX, fovRadius; //where and how far the cached fov was cast
+  bool fovValid; //false when the cached fov needs casting again
+  std::vector<Cluster> clusters; //travel pathfinding summaries, made when needed
+  std::vector<std::vector<unsigned short>> flows; //steps to a shop per region, made when needed
+  Scene scene; //shop visit or fight being played out
+  Wheel wheel; //timers for what acts on its own, see wheel.h
+  ShopTable shops; //shops someone has traded with, see shops.h
+  Arena scratch; //memory for this turn only, see arena.h
+  std::pmr::vector<Event> events{&scratch}; //what happened, waiting for the front end to show and clear
+  std::pmr::string sceneText{&scratch}; //what the scene is saying before its next pause
+  ArenaText sceneBuffer{&sceneText};
+  std::ostream sceneOut{&sceneBuffer}; //writes to sceneText
+  std::mt19937 rng; //this games own random numbers, so games can run side by side
+  unsigned int mapSeed; //seed the mines were made from, see noise.h
+  int  carveThreads = 0; //threads the caves are carved on, 0 for one per core
+  std::unordered_map<long long, Odds> odds; //miniboss fight states already worked out
+
+  //game functions
+  void Init(unsigned int seed, int size = DEFAULT_GRID);
+  void SetSize(int size);
+  bool Act(int action, int steps);
+  void EndTurn(bool update);
+  int  Rand();
+  int  Score();
+  void MemoryUse(std::vector<MemoryPart> &parts);
+  void Emit(int type, int value);
+  void ClearScratch();
+  void Move(int x);
+  bool CollectItem(int y, int x);
+  void Miniboss(const std::string &answer);
+  void EndMiniboss(bool won);
+  void MinibossStats(int &health, int &damage);
+  void MinibossOdds(Odds result[3]);
+  Odds FightOdds(int strategy, int health, int hp, int hit, int damage);
+  Odds SettleOdds(int strategy, int health, int hp, int hit, int damage);
+  void Boss(const std::string &answer);
+  void Revive(const std::string &answer);
+  bool Travel(int y, int x);
+  bool Run(int direction, int steps);
+  int  CountSighted(int sight);
+
+  //map/grid functions
+  void GenerateGrid();
+  bool SaveGame(std::ostream &MyFile);
+  bool LoadGame(std::istream &MyFile);
+
+  //shop functions
+  void CallShop(const std::string &answer);
+  void SellOre(int amount);
+  void BuyArtifacts(int amount);
+  bool Trade();
+  void TakeTrade(char input);
+  void LeaveShop();
+  void Upgrade(int x);
+  void ClearShops();
+  Shop &ShopAt(int y, int x);
+  int  OrePrice(const Shop &shop);
+  int  SellToShop(Shop &shop, int amount);
+  void QueueRestock(Shop &shop);
+  void RestockShop(int key);
+  void SaveShops(std::ostream &MyFile);
+  void LoadShops(const std::string &line);
+
+  //miner functions
+  void InitMiner(Rogue &miner, int y, int x);
+  void MoveMiners();
+  void RunTimers(std::pmr::vector<int> *owed, int y, int x, int reach);
+  void RemoveMiner(int index);
+  void QueueRespawn();
+  void RespawnMiner();
+  void MoveMiner(Rogue &miner);
+  bool ProcessBlock(Rogue &miner, int y, int x);
+  void MinerFight(const std::string &answer);
+  void BuildFlows();
+  void DirtyFlows(int y, int x);
+  int  FlowDistance(int y, int x);
+  int  FlowDirection(Rogue &miner);
+
+  //scene functions
+  void StartScene(int kind, int y, int x);
+  void StepScene(const std::string &answer);
+  void PlayScene(const std::string &answer);
+  void Pause(double seconds);
+  void Ask(int step);
+  void EndScene();
+  void EnterBlock(int y, int x);
+
+  //index functions
+  void SetBlock(int y, int x, int block);
+  void BuildIndexes();
+  int  ResourceType(int block);
+  void BuildDensity();
+  void UpdateDensity(int y, int x, int block, int amount);
+  int  DensityPrefix(int type, int tileY, int tileX);
+  int  CountResource(int type, int y1, int x1, int y2, int x2);
+  int  ScanResource(int type, int y1, int x1, int y2, int x2);
+  int  LandmarkType(int block);
+  void BuildLandmarks();
+  void AddLandmark(int y, int x, int block);
+  void RemoveLandmark(int y, int x, int block);
+  int  NearestLandmark(int type, int y, int x, int &foundY, int &foundX);
+  std::string Compass(int y, int x, int toY, int toX);
+  int  MipKind(int block);
+  void BuildPyramid();
+  void UpdatePyramid(int y, int x, int kind, int amount);
+  void MarkExplored(int y1, int x1, int y2, int x2);
+  bool IsExplored(int y, int x);
+  void SaveExplored(std::ostream &MyFile);
+  void LoadExplored(std::string line);
+  void ExploreWord(int y, int w, unsigned long long mask);
+  void UpdateFov(int sight);
+  void CastLight(int row, double start, double end, int xx, int xy, int yx, int yy);
+  bool IsVisible(int y, int x);
+  int  TravelCost(int block);
+  int  StepCost(int cell, int goal);
+  void BuildClusters();
+  void DirtyClusters(int y, int x, bool opened);
+  Cluster &GetCluster(int cy, int cx);
+  void FindEntrances(int cy, int cx, int side, Cluster &cluster);
+  void ClusterDijkstra(int from, int goal, bool reverse, std::vector<int> &dist);
+  bool RefinePath(int from, int to, int goal, int top, int left, int bottom, int right,
+                  std::vector<int> &path);
+  bool FindPath(int y, int x, int goalY, int goalX, std::vector<int> &path);
+};
+
+#endif
@@ -0,0 +1,329 @@
+//The Deep Below
+//the noise the mines are made from. each layer is value noise: a random
+//height at lattice points CELL blocks apart, eased between them. a row of a
+//layer is first eased down to the row at the lattice columns, then the 16
+//blocks of a span are eased across from the two lattice columns either side
+//of them at once. the rare blocks, shops, miners and minibosses, come from a
+//hash of each blocks spot instead. everything is in 16 bit fixed point and
+//32 bit hashes, so the scalar, SSE2 and AVX2 kernels agree to the block
+
+
+#include "noise.h"
+#include "core.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NOISE_X86 //elsewhere only the scalar kernel is built
+#include <immintrin.h>
+#endif
+
+
+int noiseKernel = NOISE_AVX2;
+
+//the layers, each with its own salt so they dont line up
+static const int OCTAVES = 5;
+static const int MAX_CELL = 64;
+static const int CELL[OCTAVES] = {64, 16, 32, 16, 16}; //caves, cave edges, veins, vein wiggle, pockets
+static const unsigned int SALT[OCTAVES] = {0x68e31da4, 0xb5297a4d, 0x1b56c4e9, 0x7fb5d329, 0xe8a4a3b5};
+
+//noise runs from 0 to 16383 in every layer
+static const int CAVE_LEVEL = 19000;  //caverns open up where caves and half their edges top this
+static const int VEIN_MIDDLE = 10239; //veins run along where veins and a quarter wiggle are this
+static const int VEIN_WIDTH = 68;     //and are ore this close to it
+static const int POCKET_LEVEL = 15400; //artifacts where pockets top this
+
+//chances of the rare blocks out of 32768
+static const int SHOP_ODDS = 98;     //.3%
+static const int MINIBOSS_ODDS = 7;  //.02%
+static const int MINER_ODDS = 49;    //.15%
+
+static const unsigned int GOLDEN = 0x9e3779b1; //steps the hash along a row
+static const unsigned int ROW_STEP = 0x85ebca77; //and between rows
+
+//how far along a lattice cell each block is, eased and in 1/32768ths
+struct Weights {
+  short eased[OCTAVES][MAX_CELL]; //cells are whole spans, so a span never runs past one
+
+  Weights() {
+    for (int o = 0; o < OCTAVES; o++) {
+      long long cell = CELL[o];
+      for (long long t = 0; t < MAX_CELL; t++)
+        eased[o][t] = t < cell ? 32767 * t * t * (3 * cell - 2 * t) / (cell * cell * cell) : 0;
+    }
+  }
+};
+
+static const Weights weights;
+
+//noise for one span of a row, what every kernel starts from
+struct SpanNoise {
+  short base[OCTAVES];          //each layer at the lattice column left of the span
+  short slope[OCTAVES];         //twice its rise to the next lattice column
+  const short *weight[OCTAVES]; //eased weights of the spans blocks
+  unsigned int first;           //hash input of the spans first block
+};
+
+//function prototypes
+static unsigned int Mix(unsigned int h);
+static void SpanScalar(const SpanNoise &span, unsigned char *out);
+#ifdef NOISE_X86
+static void SpanSse2(const SpanNoise &span, unsigned char *out);
+static void SpanAvx2(const SpanNoise &span, unsigned char *out);
+#endif
+
+
+//finds the widest kernel this computer can run, no wider than noiseKernel
+//returns the kernel, NOISE_SCALAR to NOISE_AVX2
+int NoiseKernel() {
+#ifdef NOISE_X86
+  if (noiseKernel >= NOISE_AVX2 && __builtin_cpu_supports("avx2"))
+    return NOISE_AVX2;
+  if (noiseKernel >= NOISE_SSE2 && __builtin_cpu_supports("sse2"))
+    return NOISE_SSE2;
+#endif
+  return NOISE_SCALAR;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//works out the blocks of a piece of a row. the same spot always gets the same
+//block for the same seed, whatever piece of the map it is made in
+//parameters: seed, row and first column, both 0 or more, blocks wanted and
+//where they go
+void NoiseRow(unsigned int seed, int y, int x, int count, unsigned char *blocks) {
+#ifdef NOISE_X86
+  int kernel = NoiseKernel();
+#endif
+  unsigned int upper[OCTAVES], lower[OCTAVES]; //hash inputs of the lattice rows either side
+  int eased[OCTAVES];
+  int lastIx[OCTAVES], line[OCTAVES][2]; //lattice columns last eased down to the row
+
+  for (int o = 0; o < OCTAVES; o++) {
+    int iy = y / CELL[o];
+    upper[o] = Mix(seed ^ SALT[o] ^ Mix(iy * ROW_STEP));
+    lower[o] = Mix(seed ^ SALT[o] ^ Mix((iy + 1) * ROW_STEP));
+    eased[o] = weights.eased[o][y % CELL[o]];
+    lastIx[o] = -2;
+  }
+  unsigned int rowKey = Mix(seed + (unsigned int)y * ROW_STEP);
+
+  for (int start = x / NOISE_SPAN * NOISE_SPAN; start < x + count; start += NOISE_SPAN) {
+    SpanNoise span;
+
+    for (int o = 0; o < OCTAVES; o++) {
+      int ix = start / CELL[o];
+
+      //the heights at a lattice column eased down to this row, spans inside
+      //one cell share them
+      if (ix != lastIx[o]) {
+        for (int side = 0; side < 2; side++) {
+          if (ix + side == lastIx[o] + 1 && side == 0) {
+            line[o][0] = line[o][1];
+            continue;
+          }
+          int top = Mix(upper[o] ^ ((ix + side) * GOLDEN)) >> 18;
+          int bottom = Mix(lower[o] ^ ((ix + side) * GOLDEN)) >> 18;
+          line[o][side] = top + ((2 * (bottom - top) * eased[o]) >> 16);
+        }
+        lastIx[o] = ix;
+      }
+
+      span.base[o] = line[o][0];
+      span.slope[o] = 2 * (line[o][1] - line[o][0]);
+      span.weight[o] = weights.eased[o] + start % CELL[o];
+    }
+    span.first = rowKey + (unsigned int)start * GOLDEN;
+
+    //spans hanging off either end of the piece are made on the side
+    unsigned char part[NOISE_SPAN];
+    bool whole = start >= x && start + NOISE_SPAN <= x + count;
+    unsigned char *out = whole ? blocks + (start - x) : part;
+
+#ifdef NOISE_X86
+    if (kernel == NOISE_AVX2)
+      SpanAvx2(span, out);
+    else if (kernel == NOISE_SSE2)
+      SpanSse2(span, out);
+    else
+#endif
+      SpanScalar(span, out);
+
+    if (!whole) {
+      for (int i = 0; i < NOISE_SPAN; i++)
+        if (start + i >= x && start + i < x + count)
+          blocks[start + i - x] = part[i];
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//scrambles a number so every bit of it depends on every bit put in
+//parameter: number to scramble
+//returns the scrambled number
+static unsigned int Mix(unsigned int h) {
+  h ^= h >> 16;
+  h *= 0x7feb352d;
+  h ^= h >> 15;
+  h *= 0x846ca68b;
+  h ^= h >> 16;
+  return h;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//works out a spans blocks one at a time, what the wider kernels have to match
+//parameters: the spans noise, where its 16 blocks go
+static void SpanScalar(const SpanNoise &span, unsigned char *out) {
+  for (int i = 0; i < NOISE_SPAN; i++) {
+    int noise[OCTAVES];
+    for (int o = 0; o < OCTAVES; o++)
+      noise[o] = span.base[o] + ((span.slope[o] * span.weight[o][i]) >> 16);
+
+    int cave = noise[0] + (noise[1] >> 1);
+    int vein = noise[2] + (noise[3] >> 2) - VEIN_MIDDLE;
+    int rare = Mix(span.first + i * GOLDEN) >> 17;
+    unsigned char block = DIRT;
+
+    if (cave > CAVE_LEVEL)
+      block = MINED;
+    if (noise[4] > POCKET_LEVEL)
+      block = ARTIFACT;
+    if (vein < VEIN_WIDTH && -vein < VEIN_WIDTH)
+      block = ORE;
+    if (rare < SHOP_ODDS + MINIBOSS_ODDS + MINER_ODDS)
+      block = MINER;
+    if (rare < SHOP_ODDS + MINIBOSS_ODDS)
+      block = MINIBOSS;
+    if (rare < SHOP_ODDS)
+      block = SHOP;
+    out[i] = block;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef NOISE_X86
+//SSE2 has no 32 bit multiply that keeps the low halves, so two 64 bit ones
+//do the even and odd lanes
+//parameters: numbers to multiply, 4 a side
+//returns the low 32 bits of each product
+__attribute__((target("sse2")))
+static inline __m128i MulLow(__m128i a, __m128i b) {
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//Mix on 4 numbers at once
+__attribute__((target("sse2")))
+static inline __m128i Mix4(__m128i h) {
+  h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+  h = MulLow(h, _mm_set1_epi32(0x7feb352d));
+  h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+  h = MulLow(h, _mm_set1_epi32(0x846ca68b));
+  return _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//keeps a block where a mask is set
+//parameters: blocks so far, mask, block to put there
+//returns the blocks
+__attribute__((target("sse2")))
+static inline __m128i Pick(__m128i blocks, __m128i mask, int block) {
+  return _mm_or_si128(_mm_andnot_si128(mask, blocks), _mm_and_si128(mask, _mm_set1_epi16(block)));
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//works out a spans blocks 8 at a time
+//parameters: the spans noise, where its 16 blocks go
+__attribute__((target("sse2")))
+static void SpanSse2(const SpanNoise &span, unsigned char *out) {
+  const __m128i lanes = _mm_set_epi32(3 * GOLDEN, 2 * GOLDEN, GOLDEN, 0);
+  __m128i half[2];
+
+  for (int h = 0; h < 2; h++) {
+    __m128i noise[OCTAVES];
+    for (int o = 0; o < OCTAVES; o++) {
+      __m128i weight = _mm_loadu_si128((const __m128i*)(span.weight[o] + 8 * h));
+      noise[o] = _mm_add_epi16(_mm_set1_epi16(span.base[o]),
+                               _mm_mulhi_epi16(_mm_set1_epi16(span.slope[o]), weight));
+    }
+
+    __m128i cave = _mm_add_epi16(noise[0], _mm_srai_epi16(noise[1], 1));
+    __m128i vein = _mm_add_epi16(noise[2], _mm_srai_epi16(noise[3], 2));
+    vein = _mm_sub_epi16(vein, _mm_set1_epi16(VEIN_MIDDLE));
+    vein = _mm_max_epi16(vein, _mm_sub_epi16(_mm_setzero_si128(), vein));
+
+    __m128i first = _mm_set1_epi32(span.first + 8 * h * GOLDEN);
+    __m128i low = Mix4(_mm_add_epi32(first, lanes));
+    __m128i high = Mix4(_mm_add_epi32(first, _mm_add_epi32(lanes, _mm_set1_epi32(4 * GOLDEN))));
+    __m128i rare = _mm_packs_epi32(_mm_srli_epi32(low, 17), _mm_srli_epi32(high, 17));
+
+    __m128i blocks = _mm_set1_epi16(DIRT);
+    blocks = Pick(blocks, _mm_cmpgt_epi16(cave, _mm_set1_epi16(CAVE_LEVEL)), MINED);
+    blocks = Pick(blocks, _mm_cmpgt_epi16(noise[4], _mm_set1_epi16(POCKET_LEVEL)), ARTIFACT);
+    blocks = Pick(blocks, _mm_cmplt_epi16(vein, _mm_set1_epi16(VEIN_WIDTH)), ORE);
+    blocks = Pick(blocks, _mm_cmplt_epi16(rare, _mm_set1_epi16(SHOP_ODDS + MINIBOSS_ODDS + MINER_ODDS)), MINER);
+    blocks = Pick(blocks, _mm_cmplt_epi16(rare, _mm_set1_epi16(SHOP_ODDS + MINIBOSS_ODDS)), MINIBOSS);
+    blocks = Pick(blocks, _mm_cmplt_epi16(rare, _mm_set1_epi16(SHOP_ODDS)), SHOP);
+    half[h] = blocks;
+  }
+  _mm_storeu_si128((__m128i*)out, _mm_packus_epi16(half[0], half[1]));
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//Mix on 8 numbers at once
+__attribute__((target("avx2")))
+static inline __m256i Mix8(__m256i h) {
+  h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+  h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x7feb352d));
+  h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+  h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x846ca68b));
+  return _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//keeps a block where a mask is set
+//parameters: blocks so far, mask, block to put there
+//returns the blocks
+__attribute__((target("avx2")))
+static inline __m256i Pick16(__m256i blocks, __m256i mask, int block) {
+  return _mm256_blendv_epi8(blocks, _mm256_set1_epi16(block), mask);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//works out a spans 16 blocks all at once
+//parameters: the spans noise, where its 16 blocks go
+__attribute__((target("avx2")))
+static void SpanAvx2(const SpanNoise &span, unsigned char *out) {
+  const __m256i lanes = _mm256_set_epi32(7 * GOLDEN, 6 * GOLDEN, 5 * GOLDEN, 4 * GOLDEN,
+                                         3 * GOLDEN, 2 * GOLDEN, GOLDEN, 0);
+  __m256i noise[OCTAVES];
+
+  for (int o = 0; o < OCTAVES; o++) {
+    __m256i weight = _mm256_loadu_si256((const __m256i*)span.weight[o]);
+    noise[o] = _mm256_add_epi16(_mm256_set1_epi16(span.base[o]),
+                                _mm256_mulhi_epi16(_mm256_set1_epi16(span.slope[o]), weight));
+  }
+
+  __m256i cave = _mm256_add_epi16(noise[0], _mm256_srai_epi16(noise[1], 1));
+  __m256i vein = _mm256_add_epi16(noise[2], _mm256_srai_epi16(noise[3], 2));
+  vein = _mm256_abs_epi16(_mm256_sub_epi16(vein, _mm256_set1_epi16(VEIN_MIDDLE)));
+
+  //packing works inside each 128 bit half, the permute puts the blocks back in order
+  __m256i first = _mm256_set1_epi32(span.first);
+  __m256i low = Mix8(_mm256_add_epi32(first, lanes));
+  __m256i high = Mix8(_mm256_add_epi32(first, _mm256_add_epi32(lanes, _mm256_set1_epi32(8 * GOLDEN))));
+  __m256i rare = _mm256_packs_epi32(_mm256_srli_epi32(low, 17), _mm256_srli_epi32(high, 17));
+  rare = _mm256_permute4x64_epi64(rare, _MM_SHUFFLE(3, 1, 2, 0));
+
+  __m256i blocks = _mm256_set1_epi16(DIRT);
+  blocks = Pick16(blocks, _mm256_cmpgt_epi16(cave, _mm256_set1_epi16(CAVE_LEVEL)), MINED);
+  blocks = Pick16(blocks, _mm256_cmpgt_epi16(noise[4], _mm256_set1_epi16(POCKET_LEVEL)), ARTIFACT);
+  blocks = Pick16(blocks, _mm256_cmpgt_epi16(_mm256_set1_epi16(VEIN_WIDTH), vein), ORE);
+  blocks = Pick16(blocks, _mm256_cmpgt_epi16(_mm256_set1_epi16(SHOP_ODDS + MINIBOSS_ODDS + MINER_ODDS), rare), MINER);
+  blocks = Pick16(blocks, _mm256_cmpgt_epi16(_mm256_set1_epi16(SHOP_ODDS + MINIBOSS_ODDS), rare), MINIBOSS);
+  blocks = Pick16(blocks, _mm256_cmpgt_epi16(_mm256_set1_epi16(SHOP_ODDS), rare), SHOP);
+
+  __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(blocks), _mm256_extracti128_si256(blocks, 1));
+  _mm_storeu_si128((__m128i*)out, bytes);
+}
+#endif
@@ -0,0 +1,25 @@
+//The Deep Below
+//the blocks the mines are made of, worked out from layered value noise so ore
+//comes in veins, artifacts in pockets and the dirt opens up into caverns.
+//every block only depends on the seed and where it is, so any piece of the
+//map can be made on its own and comes out the same as the whole map would.
+//whole rows are worked out 16 blocks at a time with SSE2 or AVX2, in integers
+//so every kernel makes exactly the same blocks
+
+#ifndef NOISE_H
+#define NOISE_H
+
+
+//kernels the noise can be worked out with
+#define NOISE_SCALAR 0
+#define NOISE_SSE2   1
+#define NOISE_AVX2   2
+
+static const int NOISE_SPAN = 16; //blocks worked out together, rows are made in 16 block spans
+
+extern int noiseKernel; //widest kernel the noise may use, lower it to compare against
+
+int  NoiseKernel();
+void NoiseRow(unsigned int seed, int y, int x, int count, unsigned char *blocks);
+
+#endif
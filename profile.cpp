@@ -0,0 +1,343 @@
+//The Deep Below
+//phase histograms and traces. every phase counts its times into log spaced
+//bins with relaxed atomics, and every thread keeps its spans in its own ring,
+//so game threads never wait on each other to record.
+//traces are written in the trace event format chrome://tracing and perfetto open
+
+#include "profile.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+//Constants
+static const int SUB_BINS = 8; //each doubling is split into 8 bins, about 6% wide
+static const int BINS = 62 * SUB_BINS; //covers every time a long long can hold
+static const char *PHASE_NAMES[PHASES] = {"Turn", "Input", "Move", "Collect", "Miners",
+                                          "Print", "Generate", "Save", "Load", "Scene"};
+
+//one finished span in a trace
+struct TraceEvent {
+  int  phase;
+  long long start, length; //nanoseconds since the game started
+};
+
+//the last TRACE_EVENTS spans one thread finished
+struct TraceRing {
+  int  thread;                    //order the thread first traced in
+  long long written;              //spans ever written, the ring wraps over the oldest
+  std::vector<TraceEvent> events;
+};
+
+//memory the process held at some point in the game
+struct MemoryNote {
+  const char *when;
+  long rss, peak; //kilobytes
+};
+
+bool profiling = false;
+bool tracing = false;
+bool memReport = false;
+
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+static std::atomic<unsigned long long> bins[PHASES][BINS];
+static std::atomic<unsigned long long> counts[PHASES];
+static std::atomic<unsigned long long> totals[PHASES];
+static std::atomic<unsigned long long> longest[PHASES];
+static std::mutex ringsLock; //only taken when a thread makes its ring
+static std::vector<std::unique_ptr<TraceRing>> rings; //outlive their threads for the write
+static thread_local TraceRing *ring = NULL;
+static std::vector<MemoryNote> notes; //MemoryMarks so far, main thread only
+
+//function prototypes
+static void ProfileRecord(int phase, long long nanoseconds);
+static void TraceRecord(int phase, long long start, long long length);
+static int  BinOf(unsigned long long nanoseconds);
+static double BinMiddle(int bin);
+static double Percentile(int phase, unsigned long long count, double fraction);
+static std::string Duration(double nanoseconds);
+
+
+//time on a clock that never jumps
+//returns nanoseconds since the game started
+long long ProfileNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now() - epoch).count();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//finishes a span, counting it and keeping it for the trace as asked for
+//parameters: phase, when it started from ProfileNow
+void ProfileSpan(int phase, long long start) {
+  long long length = ProfileNow() - start;
+
+  if (profiling)
+    ProfileRecord(phase, length);
+  if (tracing)
+    TraceRecord(phase, start, length);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//starts timing a phase that can be paused
+//parameter: phase
+ProfileStretch::ProfileStretch(int phase)
+    : phase(phase), on(profiling || tracing), running(false), start(0), total(0) {
+  Resume();
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//counts the time run as one sample of the phase
+ProfileStretch::~ProfileStretch() {
+  Pause();
+  if (on && profiling)
+    ProfileRecord(phase, total);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//stops the clock until Resume, keeping the stretch so far for the trace
+void ProfileStretch::Pause() {
+  if (!on || !running)
+    return;
+  long long length = ProfileNow() - start;
+  total += length;
+  running = false;
+  if (tracing)
+    TraceRecord(phase, start, length);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//starts the clock again after a Pause
+void ProfileStretch::Resume() {
+  if (!on || running)
+    return;
+  start = ProfileNow();
+  running = true;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//writes every threads spans to a trace file, oldest first. call it once the
+//threads are done
+//parameter: path of the file
+//returns true if it was written
+bool TraceWrite(const char *path) {
+  std::ofstream MyFile(path);
+  if (!MyFile)
+    return false;
+
+  bool first = true;
+  MyFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  MyFile << std::fixed << std::setprecision(3);
+
+  std::lock_guard<std::mutex> guard(ringsLock);
+  for (long long unsigned int i = 0; i < rings.size(); i++) {
+    TraceRing &each = *rings[i];
+    long long oldest = each.written > TRACE_EVENTS ? each.written - TRACE_EVENTS : 0;
+
+    MyFile << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+    MyFile << each.thread << ",\"args\":{\"name\":\"thread " << each.thread << "\"}}";
+    first = false;
+
+    //complete events, ts and dur are in microseconds
+    for (long long j = oldest; j < each.written; j++) {
+      TraceEvent &event = each.events[j % TRACE_EVENTS];
+      MyFile << ",\n{\"name\":\"" << PHASE_NAMES[event.phase] << "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+      MyFile << each.thread << ",\"ts\":" << event.start / 1e3 << ",\"dur\":" << event.length / 1e3 << "}";
+    }
+  }
+
+  MyFile << "\n]}\n";
+  return (bool)MyFile;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//memory this process holds, from /proc/self/status where there is one
+//parameter: true for the most it has held at once, false for right now
+//returns kilobytes, 0 where it cant be told
+long MemoryKb(bool peak) {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return 0;
+  return (long)((peak ? counters.PeakWorkingSetSize : counters.WorkingSetSize) / 1024);
+#else
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  const char *key = peak ? "VmHWM:" : "VmRSS:";
+  while (std::getline(status, line))
+    if (line.compare(0, 6, key) == 0)
+      return atol(line.c_str() + 6);
+
+  //no /proc, ex. mac, only the peak can be had and it is in bytes there
+  if (!peak)
+    return 0;
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//notes how much memory is held now, if memory is being reported
+//parameter: when in the game this is, kept as is so it should be a literal
+void MemoryMark(const char *when) {
+  if (!memReport)
+    return;
+
+  MemoryNote note;
+  note.when = when;
+  note.rss = MemoryKb(false);
+  note.peak = MemoryKb(true);
+  notes.push_back(note);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//prints every MemoryMark so far
+//parameter: where to print
+void MemoryMarks(std::ostream &out) {
+  out << "Process memory          RSS        peak\n";
+  for (long long unsigned int i = 0; i < notes.size(); i++) {
+    out << std::left << std::setw(18) << notes[i].when << std::right;
+    out << std::setw(10) << notes[i].rss << "kB" << std::setw(10) << notes[i].peak << "kB\n";
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//counts one time into a phase
+//parameters: phase, time it took in nanoseconds
+static void ProfileRecord(int phase, long long nanoseconds) {
+  unsigned long long time = nanoseconds < 0 ? 0 : nanoseconds;
+  unsigned long long most = longest[phase].load(std::memory_order_relaxed);
+
+  bins[phase][BinOf(time)].fetch_add(1, std::memory_order_relaxed);
+  counts[phase].fetch_add(1, std::memory_order_relaxed);
+  totals[phase].fetch_add(time, std::memory_order_relaxed);
+  while (time > most && !longest[phase].compare_exchange_weak(most, time, std::memory_order_relaxed))
+    ;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//keeps a span in this threads ring, making the ring the first time
+//parameters: phase, when it started and how long it took in nanoseconds
+static void TraceRecord(int phase, long long start, long long length) {
+  if (ring == NULL) {
+    std::lock_guard<std::mutex> guard(ringsLock);
+    rings.push_back(std::unique_ptr<TraceRing>(new TraceRing));
+    ring = rings.back().get();
+    ring->thread = rings.size() - 1;
+    ring->written = 0;
+    ring->events.resize(TRACE_EVENTS);
+  }
+
+  TraceEvent &event = ring->events[ring->written % TRACE_EVENTS];
+  event.phase = phase;
+  event.start = start;
+  event.length = length;
+  ring->written++;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//prints the count, middle, tail and total of every phase timed so far
+//parameter: where to print
+void ProfileReport(std::ostream &out) {
+  out << "Phase          count       p50       p99       max     total\n";
+
+  for (int i = 0; i < PHASES; i++) {
+    unsigned long long count = counts[i].load(std::memory_order_relaxed);
+    if (count == 0)
+      continue;
+
+    out << std::left << std::setw(10) << PHASE_NAMES[i] << std::right;
+    out << std::setw(9) << count;
+    out << std::setw(10) << Duration(Percentile(i, count, 0.5));
+    out << std::setw(10) << Duration(Percentile(i, count, 0.99));
+    out << std::setw(10) << Duration(longest[i].load(std::memory_order_relaxed));
+    out << std::setw(10) << Duration(totals[i].load(std::memory_order_relaxed)) << '\n';
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//finds the bin a time goes in, times under 8ns get a bin each
+//parameter: time in nanoseconds
+//returns the bin
+static int BinOf(unsigned long long nanoseconds) {
+  int doublings = 0;
+
+  if (nanoseconds < SUB_BINS)
+    return nanoseconds;
+  while (nanoseconds >= SUB_BINS * 2) {
+    nanoseconds >>= 1;
+    doublings++;
+  }
+  return (doublings + 1) * SUB_BINS + (nanoseconds - SUB_BINS);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//the time in the middle of a bin
+//parameter: bin
+//returns time in nanoseconds
+static double BinMiddle(int bin) {
+  if (bin < SUB_BINS)
+    return bin;
+
+  int doublings = bin / SUB_BINS - 1;
+  double low = (double)(SUB_BINS + bin % SUB_BINS) * (1ULL << doublings);
+  return low + (1ULL << doublings) / 2.0;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//walks a phases bins to the one holding the given share of its times
+//parameters: phase, times counted, share from 0 to 1
+//returns time in nanoseconds
+static double Percentile(int phase, unsigned long long count, double fraction) {
+  unsigned long long rank = (unsigned long long)(count * fraction);
+  unsigned long long seen = 0;
+  double most = longest[phase].load(std::memory_order_relaxed);
+
+  //the middle of the top bin can be past the longest time actually seen
+  for (int i = 0; i < BINS; i++) {
+    seen += bins[phase][i].load(std::memory_order_relaxed);
+    if (seen > rank)
+      return BinMiddle(i) < most ? BinMiddle(i) : most;
+  }
+  return most;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//writes a time in whichever unit reads best
+//parameter: time in nanoseconds
+//returns the time, ex. 1.25ms
+static std::string Duration(double nanoseconds) {
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(2);
+
+  if (nanoseconds < 1e3)
+    text << nanoseconds << "ns";
+  else if (nanoseconds < 1e6)
+    text << nanoseconds / 1e3 << "us";
+  else if (nanoseconds < 1e9)
+    text << nanoseconds / 1e6 << "ms";
+  else
+    text << nanoseconds / 1e9 << "s";
+  return text.str();
+}
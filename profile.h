@@ -0,0 +1,76 @@
+//The Deep Below
+//per phase timers. a ProfileScope at the top of a function times it into that
+//phases histogram and the trace, when both are off it only checks a flag.
+//also reads how much memory the process holds
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <iosfwd>
+
+
+//phases timed
+#define TURN_PHASE     0 //a move, the end of its turn and the print, not scenes or menus
+#define INPUT_PHASE    1
+#define MOVE_PHASE     2 //includes collecting
+#define COLLECT_PHASE  3
+#define MINERS_PHASE   4
+#define PRINT_PHASE    5
+#define GENERATE_PHASE 6
+#define SAVE_PHASE     7
+#define LOAD_PHASE     8
+#define SCENE_PHASE    9 //a shop visit or fight from start to end
+
+static const int PHASES = 10; //num of phases timed
+static const int TRACE_EVENTS = 65536; //spans each thread keeps for the trace, oldest go first
+
+extern bool profiling; //true to time phases, set before any threads start
+extern bool tracing;   //true to keep spans for a trace file, same
+extern bool memReport; //true to note memory at each MemoryMark
+
+//times the block it is declared in
+struct ProfileScope {
+  int  phase;
+  bool on; //profiling or tracing was on when the scope started
+  long long start;
+
+  explicit ProfileScope(int phase);
+  ~ProfileScope();
+};
+
+//times a phase that stops for waits in the middle, like a turn stopping
+//while the player answers a scene. the histogram gets one sample of the
+//time it ran, the trace a span for each stretch of it
+struct ProfileStretch {
+  int  phase;
+  bool on;        //profiling or tracing was on when it started
+  bool running;   //false while paused
+  long long start, total; //when this stretch started, time run before it
+
+  explicit ProfileStretch(int phase);
+  ~ProfileStretch();
+  void Pause();
+  void Resume();
+};
+
+long long ProfileNow();
+void ProfileSpan(int phase, long long start);
+void ProfileReport(std::ostream &out);
+bool TraceWrite(const char *path);
+long MemoryKb(bool peak);
+void MemoryMark(const char *when);
+void MemoryMarks(std::ostream &out);
+
+
+//kept in the header so a scope with profiling off is only the flag check
+inline ProfileScope::ProfileScope(int phase) : phase(phase), on(profiling || tracing), start(0) {
+  if (on)
+    start = ProfileNow();
+}
+
+inline ProfileScope::~ProfileScope() {
+  if (on)
+    ProfileSpan(phase, start);
+}
+
+#endif
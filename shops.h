@@ -0,0 +1,103 @@
+//The Deep Below
+//what each shop remembers between visits. there are thousands of shops and
+//most are never traded with, so a shop only gets a place in the table the
+//first time someone does. the table is one flat array of places, a shop is
+//looked for from where its packed YX hashes to and on along the array until
+//it or an empty place turns up, so there are no links to chase
+
+#ifndef SHOPS_H
+#define SHOPS_H
+
+#include <vector>
+
+
+static const int NO_SHOP = -1; //key of an empty place
+
+//one shops stock and prices
+struct Shop {
+  int  key;            //packed YX of the shop, NO_SHOP for an empty place
+  int  ore;            //ore sold to it and not shipped off yet, it pays less the more it has
+  unsigned char stock; //artifacts it has for sale
+  unsigned char offer; //upgrade it has for sale, NO_OFFER once sold
+  unsigned char cost;  //artifacts the upgrade costs
+  bool restocking;     //true while a restock timer is set for it
+};
+
+struct ShopTable {
+  std::vector<Shop> places; //a power of two of them, never more than 3/4 full
+  int  shift; //32 less the bits of a hash that pick a place
+  int  count; //shops in the table
+
+  ShopTable() {
+    Clear(0);
+  }
+
+  //empties the table, with room for some shops before it has to grow
+  //parameter: shops to make room for
+  void Clear(int room) {
+    int bits = 4;
+    while ((1LL << bits) * 3 / 4 < room)
+      bits++;
+
+    Shop empty = Shop();
+    empty.key = NO_SHOP;
+    places.assign(1 << bits, empty);
+    shift = 32 - bits;
+    count = 0;
+  }
+
+  //looks for a shop
+  //parameter: packed YX of the shop
+  //returns the shop, NULL if it isnt in the table
+  Shop *Find(int key) {
+    int mask = places.size() - 1;
+    for (int i = Home(key); places[i].key != NO_SHOP; i = (i + 1) & mask)
+      if (places[i].key == key)
+        return &places[i];
+    return NULL;
+  }
+
+  //puts a shop that isnt in the table yet into it, the rest is left to the
+  //caller to fill. shops found before may move when the table grows
+  //parameter: packed YX of the shop
+  //returns the new shop
+  Shop &Add(int key) {
+    if ((count + 1) * 4 > (int)places.size() * 3)
+      Grow();
+
+    int mask = places.size() - 1;
+    int i = Home(key);
+    while (places[i].key != NO_SHOP)
+      i = (i + 1) & mask;
+
+    places[i].key = key;
+    count++;
+    return places[i];
+  }
+
+  //memory held
+  long long Bytes() const {
+    return places.capacity() * sizeof(Shop);
+  }
+
+ private:
+  //place a key is looked for from first, fibonacci hashing spreads the
+  //packed YX of neighbouring shops over the whole table
+  //parameter: packed YX
+  int Home(int key) const {
+    return (unsigned int)key * 2654435769u >> shift;
+  }
+
+  //doubles the table and puts every shop back in
+  void Grow() {
+    std::vector<Shop> old;
+    old.swap(places);
+    Clear(count * 2);
+
+    for (long long unsigned int i = 0; i < old.size(); i++)
+      if (old[i].key != NO_SHOP)
+        Add(old[i].key) = old[i];
+  }
+};
+
+#endif
@@ -0,0 +1,178 @@
+//The Deep Below
+//a timing wheel of what happens on which turn. everything that acts on its
+//own, miners, the miners that come to replace the fallen and shops getting
+//their stock back, sets a timer for the turn it next acts on, and a turn only
+//looks at the timers going off on it. the near turns get a slot each, further
+//turns are kept in coarser slots that are handed down to the finer ones as
+//they come up
+
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include <vector>
+
+
+static const int WHEEL_BITS = 6; //64 slots a level
+static const int WHEEL_SLOTS = 1 << WHEEL_BITS;
+static const int WHEEL_LEVELS = 3; //slots of 1, 64 and 4096 turns, 262144 turns ahead
+
+//timer types
+#define NO_TIMER      0 //cancelled, thrown away when its slot comes up
+#define MINER_TIMER   1 //a miner moves, id is its index in MinerList
+#define RESPAWN_TIMER 2 //a new miner comes in for a fallen one
+#define RESTOCK_TIMER 3 //a shop ships off ore and gets an artifact in, id is its packed YX
+
+//one thing that goes off on a given turn
+struct Timer {
+  long long due; //turn it goes off on
+  int  kind;     //timer type, see above
+  int  id;       //what it is for, depends on the type
+  int  next;     //next timer in the same slot or on the free list, -1 at the end
+};
+
+struct Wheel {
+  std::vector<Timer> timers; //set and free timers, a timers index is its handle
+  int  head[WHEEL_LEVELS][WHEEL_SLOTS]; //first timer in each slot, -1 if none
+  int  tail[WHEEL_LEVELS][WHEEL_SLOTS]; //last, so a slot goes off in the order it was set
+  int  unused;   //first free timer, -1 if none
+  int  set;      //timers set and not yet gone off, cancelled ones included
+  long long now; //turn the wheel is on
+
+  Wheel() {
+    Clear(0);
+  }
+
+  //throws every timer away and starts the wheel at a turn
+  //parameters: the turn, timers to make room for
+  void Clear(long long turn, int room = 0) {
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+      for (int slot = 0; slot < WHEEL_SLOTS; slot++) {
+        head[level][slot] = -1;
+        tail[level][slot] = -1;
+      }
+    }
+    timers.clear();
+    timers.reserve(room);
+    unused = -1;
+    set = 0;
+    now = turn;
+  }
+
+  //sets a timer, turns before the next one go off on the next
+  //parameters: turn it goes off on, timer type and what it is for
+  //returns the timers handle, it stays the same until the timer goes off
+  int Set(long long due, int kind, int id) {
+    int timer = unused;
+    if (timer == -1) {
+      timer = timers.size();
+      timers.push_back(Timer());
+    } else {
+      unused = timers[timer].next;
+    }
+
+    timers[timer].kind = kind;
+    timers[timer].id = id;
+    Rearm(timer, due);
+    set++;
+    return timer;
+  }
+
+  //sets a timer that just went off again, keeping its handle
+  //parameters: the timers handle from Pop and the turn it goes off on next
+  void Rearm(int timer, long long due) {
+    timers[timer].due = due > now ? due : now + 1;
+    Link(timer);
+  }
+
+  //stops a timer going off. it stays in its slot until the slot comes up
+  //parameter: the timers handle
+  void Cancel(int timer) {
+    timers[timer].kind = NO_TIMER;
+  }
+
+  //takes the next timer going off this turn out of the wheel. it has to be
+  //rearmed or freed once dealt with
+  //returns the timers handle, -1 when there are no more this turn
+  int Pop() {
+    int slot = now & (WHEEL_SLOTS - 1);
+
+    while (head[0][slot] != -1) {
+      int timer = head[0][slot];
+      head[0][slot] = timers[timer].next;
+      if (head[0][slot] == -1)
+        tail[0][slot] = -1;
+
+      if (timers[timer].kind != NO_TIMER)
+        return timer;
+      Free(timer);
+    }
+    return -1;
+  }
+
+  //gives back a timer from Pop that wont be set again
+  //parameter: the timers handle
+  void Free(int timer) {
+    timers[timer].next = unused;
+    unused = timer;
+    set--;
+  }
+
+  //moves on to the next turn, handing down the coarser slots that come up
+  void Advance() {
+    now++;
+    if ((now & (WHEEL_SLOTS - 1)) != 0)
+      return;
+    if ((now & (WHEEL_SLOTS * WHEEL_SLOTS - 1)) == 0)
+      HandDown(2, (now >> (2 * WHEEL_BITS)) & (WHEEL_SLOTS - 1));
+    HandDown(1, (now >> WHEEL_BITS) & (WHEEL_SLOTS - 1));
+  }
+
+ private:
+  //puts a timer on the end of the slot for its turn, timers past the last
+  //level wait in its furthest slot and are put back each time it comes up
+  //parameter: the timers handle
+  void Link(int timer) {
+    long long due = timers[timer].due;
+    int level = WHEEL_LEVELS - 1;
+    int slot = ((now >> (level * WHEEL_BITS)) + WHEEL_SLOTS - 1) & (WHEEL_SLOTS - 1);
+
+    if (due - now < WHEEL_SLOTS) {
+      level = 0;
+      slot = due & (WHEEL_SLOTS - 1);
+    } else {
+      for (int i = 1; i < WHEEL_LEVELS; i++) {
+        if ((due >> (i * WHEEL_BITS)) - (now >> (i * WHEEL_BITS)) < WHEEL_SLOTS) {
+          level = i;
+          slot = (due >> (i * WHEEL_BITS)) & (WHEEL_SLOTS - 1);
+          break;
+        }
+      }
+    }
+
+    timers[timer].next = -1;
+    if (tail[level][slot] == -1)
+      head[level][slot] = timer;
+    else
+      timers[tail[level][slot]].next = timer;
+    tail[level][slot] = timer;
+  }
+
+  //sorts a coarse slot that came up into the finer ones, in order
+  //parameters: level and slot
+  void HandDown(int level, int slot) {
+    int timer = head[level][slot];
+    head[level][slot] = -1;
+    tail[level][slot] = -1;
+
+    while (timer != -1) {
+      int next = timers[timer].next;
+      if (timers[timer].kind == NO_TIMER)
+        Free(timer);
+      else
+        Link(timer);
+      timer = next;
+    }
+  }
+};
+
+#endif
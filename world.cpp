@@ -0,0 +1,84 @@
+//The Deep Below
+//memory for the map. big maps span thousands of 4kB pages and miners are
+//spread over all of them, so the buffer asks for 2MB pages where it can get
+//them: reserved huge pages first, then transparent huge pages, then plain
+//memory. the pages are first touched by whoever fills the map, so batch
+//games each fault theirs in on the thread that plays them
+
+
+#include "world.h"
+
+#include <cstdlib>
+
+#if defined(__linux__) //elsewhere the map gets plain memory
+#include <sys/mman.h>
+#endif
+
+
+bool hugePages = true;
+
+static const long long HUGE_PAGE = 2 * 1024 * 1024; //2MB pages
+
+
+//gets zeroed memory for a map buffer
+//parameters: bytes wanted, set to how the memory was got (see world.h) and
+//to the bytes really held
+//returns the memory, NULL if there is none
+void *MapBlocks(long long bytes, int &pages, long long &held) {
+  pages = PLAIN_PAGES;
+  held = bytes;
+
+#if defined(__linux__)
+  if (hugePages && bytes >= HUGE_PAGE) {
+    long long rounded = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+
+    //reserved huge pages only exist if someone set them aside
+    void *memory = mmap(NULL, rounded, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+      pages = RESERVED_PAGES;
+      held = rounded;
+      return memory;
+    }
+
+    //otherwise takes an extra page to line the buffer up on a 2MB boundary
+    //so the kernel can back it with transparent huge pages, then gives back
+    //the ends it didnt need
+    char *raw = (char*)mmap(NULL, rounded + HUGE_PAGE, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw != MAP_FAILED) {
+      char *aligned = (char*)(((unsigned long long)raw + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE);
+      if (aligned > raw)
+        munmap(raw, aligned - raw);
+      munmap(aligned + rounded, raw + HUGE_PAGE - aligned);
+
+      held = rounded;
+      pages = MAPPED_PAGES;
+#ifdef MADV_HUGEPAGE
+      if (madvise(aligned, rounded, MADV_HUGEPAGE) == 0)
+        pages = HUGE_PAGES;
+#endif
+      return aligned;
+    }
+  }
+#endif
+
+  return calloc(bytes, 1);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+//gives back memory from MapBlocks
+//parameters: the memory, how it was got and the bytes held
+void UnmapBlocks(void *memory, int pages, long long held) {
+  if (memory == NULL)
+    return;
+
+#if defined(__linux__)
+  if (pages != PLAIN_PAGES) {
+    munmap(memory, held);
+    return;
+  }
+#endif
+  (void)held;
+  free(memory);
+}
@@ -0,0 +1,94 @@
+//The Deep Below
+//the blocks of the map in one buffer. rows are a power of two long so finding
+//a block is a shift and an add, and a band of EDGE blocks goes all the way
+//around the map so looking next to any block on it never needs a bounds check.
+//the buffer is backed by huge pages where the system has them
+
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include <new>
+
+
+//blocks of edge around the map, more than anything reaches past a block:
+//sight is at most 7 and digging upgrades reach 2 ahead
+static const int GUARD = 8;
+
+//how a maps memory was got
+#define PLAIN_PAGES    0 //the heap
+#define MAPPED_PAGES   1 //mapped for huge pages but the system wouldnt use them
+#define HUGE_PAGES     2 //transparent huge pages asked for
+#define RESERVED_PAGES 3 //huge pages set aside by the system
+
+extern bool hugePages; //false to always use plain memory, to compare against
+
+void *MapBlocks(long long bytes, int &pages, long long &held);
+void UnmapBlocks(void *memory, int pages, long long held);
+
+template <typename CellT>
+struct World {
+  CellT *cells;
+  long long held; //bytes held, band, padding and page rounding included
+  int  pages; //how the memory was got
+  int  shift; //rows are 1 << shift blocks apart
+  int  size;  //blocks per side of the map, not counting the band
+
+  World() : cells(NULL), held(0), pages(PLAIN_PAGES), shift(0), size(0) {}
+  ~World() {
+    UnmapBlocks(cells, pages, held);
+  }
+  World(const World &) = delete; //one map, one owner
+  World &operator=(const World &) = delete;
+
+  //makes a map of size x size blocks of fill, with the guard band set to edge
+  //parameters: blocks per side, block for the map, block for the band
+  void Assign(int size, CellT fill, CellT edge) {
+    int side = size + 2 * GUARD;
+
+    this->size = size;
+    shift = 0;
+    while ((1LL << shift) < side)
+      shift++;
+
+    UnmapBlocks(cells, pages, held);
+    cells = (CellT*)MapBlocks(((long long)side << shift) * sizeof(CellT), pages, held);
+    if (cells == NULL)
+      throw std::bad_alloc();
+
+    //the padding at the end of each row is band too
+    std::fill(cells, cells + ((long long)side << shift), edge);
+    for (int y = 0; y < size; y++)
+      std::fill((*this)[y], (*this)[y] + size, fill);
+  }
+
+  //trades maps with another, neither is copied
+  //parameter: the other map
+  void Swap(World &other) {
+    std::swap(cells, other.cells);
+    std::swap(held, other.held);
+    std::swap(pages, other.pages);
+    std::swap(shift, other.shift);
+    std::swap(size, other.size);
+  }
+
+  //row of the map, indexing past either end of it lands in the band
+  //parameter: row, -GUARD to size + GUARD - 1
+  //returns the rows first block
+  CellT *operator[](int y) {
+    return cells + ((long long)(y + GUARD) << shift) + GUARD;
+  }
+
+  const CellT *operator[](int y) const {
+    return cells + ((long long)(y + GUARD) << shift) + GUARD;
+  }
+
+  //memory held, band and padding included
+  long long Bytes() const {
+    return held;
+  }
+};
+
+#endif